@@ -2,19 +2,58 @@
 
 #include <vector>
 #include <fstream>
-#include <stack>
+#include <string>
+#include <stdexcept>
 #include <algorithm>
+#include <iterator>
+#include <utility>
+#include <tuple>
+
+#include <graph/parallel.h>
+#include <graph/columns.h>
+#include <graph/stats.h>
+
+/**
+* Handle which doesn't reference any node or edge
+*/
+const size_t invalid_handle = static_cast<size_t>(-1);
 
 /**
-* Oriented graph with values on each node of given type
+* Empty value type used for edges which carry no data
+*/
+struct no_value {};
+
+inline bool operator==(no_value const&, no_value const&) {
+    return true;
+}
+
+inline std::ostream& operator<<(std::ostream& out, no_value const&) {
+    return out;
+}
+
+inline std::istream& operator>>(std::istream& in, no_value&) {
+    return in;
+}
+
+/**
+* Oriented graph with values on each node and on each edge of given types
 * @tparam T type of values on nodes
+* @tparam E type of values on edges
 */
-template<typename T>
+template<typename T, typename E = no_value>
 class graph_t {
 public:
     typedef size_t node_handle;
     typedef size_t edge_handle;
 
+    /**
+    * Maps old handles to new ones after compaction, removed handles are mapped to invalid_handle
+    */
+    struct remapping_t {
+        std::vector<node_handle> nodes;
+        std::vector<edge_handle> edges;
+    };
+
     /**
     * Constructs empty graph
     */
@@ -40,7 +79,20 @@ public:
         , payloads(std::move(origin.payloads))
         , from(std::move(origin.from))
         , to(std::move(origin.to))
-    {}
+        , edge_payloads(std::move(origin.edge_payloads))
+        , in_nodes(std::move(origin.in_nodes))
+        , in_index_built(origin.in_index_built)
+        , removed_nodes(std::move(origin.removed_nodes))
+        , removed_edges(std::move(origin.removed_edges))
+        , removed_nodes_count(origin.removed_nodes_count)
+        , removed_edges_count(origin.removed_edges_count)
+        , node_columns(std::move(origin.node_columns))
+        , edge_columns(std::move(origin.edge_columns))
+    {
+        origin.in_index_built.set(false);
+        origin.removed_nodes_count = 0;
+        origin.removed_edges_count = 0;
+    }
 
     /**
     * Assigns existing graph
@@ -52,11 +104,20 @@ public:
         std::swap(payloads, graph.payloads);
         std::swap(from, graph.from);
         std::swap(to, graph.to);
+        std::swap(edge_payloads, graph.edge_payloads);
+        std::swap(in_nodes, graph.in_nodes);
+        in_index_built = graph.in_index_built;
+        std::swap(removed_nodes, graph.removed_nodes);
+        std::swap(removed_edges, graph.removed_edges);
+        std::swap(removed_nodes_count, graph.removed_nodes_count);
+        std::swap(removed_edges_count, graph.removed_edges_count);
+        std::swap(node_columns, graph.node_columns);
+        std::swap(edge_columns, graph.edge_columns);
         return *this;
     }
 
     /**
-    * Checks if this graph is equal to given
+    * Checks if this graph is equal to given. Attribute columns are not compared.
     * @param graph value to compare with
     * @return true if this == graph, false othrewise
     */
@@ -64,7 +125,10 @@ public:
         return nodes == graph.nodes
                 && payloads == graph.payloads
                 && from == graph.from
-                && to == graph.to;
+                && to == graph.to
+                && edge_payloads == graph.edge_payloads
+                && removed_nodes == graph.removed_nodes
+                && removed_edges == graph.removed_edges;
     }
 
     /**
@@ -77,7 +141,8 @@ public:
     }
 
     /**
-    * Loads graph from file with given name to this instance discarding any existing data in this instance.
+    * Loads graph from file with given name to this instance discarding any existing data in this instance,
+    * including attribute columns.
     * @param filename to load graph data from
     */
     void load_from_file(std::string const& filename) {
@@ -95,18 +160,33 @@ public:
         nodes.assign(n, std::vector<edge_handle>());
         from.assign(m, 0);
         to.assign(m, 0);
+        edge_payloads.assign(m, E());
+        removed_nodes.assign(n, false);
+        removed_edges.assign(m, false);
+        removed_nodes_count = removed_edges_count = 0;
 
         for (size_t i = 0; i < m; ++i) {
-            in >> from[i] >> to[i];
+            in >> from[i] >> to[i] >> edge_payloads[i];
             nodes[from[i]].push_back(i);
         }
+        drop_in_index();
+        node_columns.clear();
+        edge_columns.clear();
     }
 
     /**
-    * Saves graph data to file with given name.
+    * Saves graph data to file with given name. Attribute columns are not saved.
+    * Removed nodes and edges are not saved, so handles of loaded graph are the ones after compact().
     * @param filename to load graph data from
     */
     void save_to_file(std::string const& filename) const {
+        if (removed_nodes_count != 0 || removed_edges_count != 0) {
+            graph_t compacted(*this);
+            compacted.compact();
+            compacted.save_to_file(filename);
+            return;
+        }
+
         std::ofstream out(filename.c_str());
 
         out << nodes.size() << " " << from.size() << std::endl;
@@ -117,7 +197,7 @@ public:
         out << std::endl;
 
         for (size_t i = 0; i < from.size(); ++i) {
-            out << from[i] << " " << to[i] << std::endl;
+            out << from[i] << " " << to[i] << " " << edge_payloads[i] << std::endl;
         }
     }
 
@@ -128,6 +208,10 @@ public:
     node_handle add_node() {
         nodes.resize(nodes.size() + 1);
         payloads.resize(payloads.size() + 1);
+        removed_nodes.push_back(false);
+        node_columns.resize(nodes.size());
+        if (in_index_built.get())
+            in_nodes.resize(nodes.size());
         return nodes.size() - 1;
     }
 
@@ -135,16 +219,339 @@ public:
     * Adds new edges with given ends and returns it's handle
     * @param a start node handle
     * @param b end node handle
+    * @param value to put on the edge
     * @return handle to the newly created edge
     */
-    edge_handle add_edge(node_handle const& a, node_handle const& b) {
+    edge_handle add_edge(node_handle const& a, node_handle const& b, E const& value = E()) {
         from.push_back(a);
         to.push_back(b);
+        edge_payloads.push_back(value);
+        removed_edges.push_back(false);
+        edge_columns.resize(from.size());
         edge_handle edge = from.size() - 1;
         nodes[a].push_back(edge);
+        if (in_index_built.get())
+            in_nodes[b].push_back(edge);
         return edge;
     }
 
+    /**
+    * Reserves memory for given total number of nodes
+    * @param count number of nodes
+    */
+    void reserve_nodes(size_t count) {
+        nodes.reserve(count);
+        payloads.reserve(count);
+        removed_nodes.reserve(count);
+    }
+
+    /**
+    * Reserves memory for given total number of edges
+    * @param count number of edges
+    */
+    void reserve_edges(size_t count) {
+        from.reserve(count);
+        to.reserve(count);
+        edge_payloads.reserve(count);
+        removed_edges.reserve(count);
+    }
+
+    /**
+    * Adds edges from given range. Counts degrees first, so each storage vector grows at most once.
+    * Elements of the range are std::pair<node_handle, node_handle> or std::tuple<node_handle, node_handle, E>.
+    * @param first iterator to the first edge, must be at least forward iterator
+    * @param last iterator past the last edge
+    * @tparam Iterator type of iterators
+    * @return handle of the first added edge, following ones have consecutive handles
+    * @throws std::runtime_error if any edge end doesn't exist, graph isn't changed in that case
+    */
+    template<typename Iterator>
+    edge_handle add_edges(Iterator first, Iterator last) {
+        edge_handle result = from.size();
+        std::vector<size_t> degrees(nodes.size(), 0);
+        size_t count = 0;
+        for (Iterator it = first; it != last; ++it, ++count) {
+            node_handle a = source_of(*it);
+            node_handle b = target_of(*it);
+            if (a >= nodes.size() || b >= nodes.size())
+                throw std::runtime_error("edge end doesn't exist");
+            ++degrees[a];
+        }
+
+        reserve_edges(from.size() + count);
+        for (node_handle node = 0; node < nodes.size(); ++node) {
+            if (degrees[node] != 0)
+                nodes[node].reserve(nodes[node].size() + degrees[node]);
+        }
+
+        for (Iterator it = first; it != last; ++it) {
+            node_handle a = source_of(*it);
+            node_handle b = target_of(*it);
+            edge_handle edge = from.size();
+            from.push_back(a);
+            to.push_back(b);
+            edge_payloads.push_back(value_of(*it));
+            removed_edges.push_back(false);
+            nodes[a].push_back(edge);
+            if (in_index_built.get())
+                in_nodes[b].push_back(edge);
+        }
+        edge_columns.resize(from.size());
+        return result;
+    }
+
+    /**
+    * Adds edges from given range.
+    * @param edges range of std::pair<node_handle, node_handle> or std::tuple<node_handle, node_handle, E>
+    * @tparam EdgeRange type of range
+    * @return handle of the first added edge, following ones have consecutive handles
+    * @throws std::runtime_error if any edge end doesn't exist, graph isn't changed in that case
+    */
+    template<typename EdgeRange>
+    edge_handle add_edges(EdgeRange const& edges) {
+        return add_edges(std::begin(edges), std::end(edges));
+    }
+
+    /**
+    * Builds graph with given number of nodes with default values and given edges.
+    * Edge handles are equal to positions of edges in the list, edges of each node are in the list order.
+    * Storage is allocated once, and with more than one thread edges are split into chunks which
+    * are counted and placed by separate threads, using nodes count * threads extra memory for counters.
+    * @param n number of nodes
+    * @param edges random access range of std::pair<node_handle, node_handle>
+    *        or std::tuple<node_handle, node_handle, E>
+    * @param threads maximum number of threads to use
+    * @tparam EdgeRange type of range
+    * @return built graph
+    * @throws std::runtime_error if any edge end doesn't exist
+    */
+    template<typename EdgeRange>
+    static graph_t from_edge_list(size_t n, EdgeRange const& edges, size_t threads = 1) {
+        auto first = std::begin(edges);
+        size_t m = std::distance(first, std::end(edges));
+        threads = std::max<size_t>(1, std::min<size_t>(threads, m / min_parallel_edges));
+
+        graph_t graph;
+        graph.payloads.assign(n, T());
+        graph.removed_nodes.assign(n, false);
+        graph.nodes.resize(n);
+        graph.from.resize(m);
+        graph.to.resize(m);
+        graph.edge_payloads.resize(m);
+        graph.removed_edges.assign(m, false);
+
+        std::vector<std::vector<size_t>> counts(threads, std::vector<size_t>(n, 0));
+        std::vector<char> failed(threads, false);
+        graph_detail::parallel_for(0, m, threads, [&](size_t thread, size_t lo, size_t hi) {
+            std::vector<size_t>& count = counts[thread];
+            for (size_t i = lo; i < hi; ++i) {
+                auto const& edge = *(first + i);
+                node_handle a = source_of(edge);
+                node_handle b = target_of(edge);
+                if (a >= n || b >= n) {
+                    failed[thread] = true;
+                    return;
+                }
+                graph.from[i] = a;
+                graph.to[i] = b;
+                graph.edge_payloads[i] = value_of(edge);
+                ++count[a];
+            }
+        });
+        if (std::find(failed.begin(), failed.end(), true) != failed.end())
+            throw std::runtime_error("edge end doesn't exist");
+
+        graph_detail::parallel_for(0, n, threads, [&](size_t, size_t lo, size_t hi) {
+            for (node_handle node = lo; node < hi; ++node) {
+                size_t degree = 0;
+                for (std::vector<size_t>& count : counts) {
+                    size_t chunk = count[node];
+                    count[node] = degree;
+                    degree += chunk;
+                }
+                graph.nodes[node].resize(degree);
+            }
+        });
+
+        graph_detail::parallel_for(0, m, threads, [&](size_t thread, size_t lo, size_t hi) {
+            std::vector<size_t>& position = counts[thread];
+            for (edge_handle edge = lo; edge < hi; ++edge) {
+                node_handle a = graph.from[edge];
+                graph.nodes[a][position[a]++] = edge;
+            }
+        });
+        return graph;
+    }
+
+    /**
+    * Removes given edge. Takes O(1): edge is only marked as removed and skipped by traversals
+    * until compact() is called. Handles of other edges and nodes stay valid.
+    * @param edge to remove
+    * @throws std::runtime_error if edge is already removed
+    */
+    void remove_edge(edge_handle const& edge) {
+        if (!has_edge(edge))
+            throw std::runtime_error("edge is already removed");
+        removed_edges[edge] = true;
+        ++removed_edges_count;
+    }
+
+    /**
+    * Removes given node together with all edges starting or ending at it. Takes O(1): node is only
+    * marked as removed and skipped by traversals until compact() is called. Snapshots such as csr_t
+    * keep handles of removed nodes as isolated nodes. Handles of other edges and nodes stay valid.
+    * @param node to remove
+    * @throws std::runtime_error if node is already removed
+    */
+    void remove_node(node_handle const& node) {
+        if (!has_node(node))
+            throw std::runtime_error("node is already removed");
+        removed_nodes[node] = true;
+        ++removed_nodes_count;
+    }
+
+    /**
+    * Checks if given node exists and isn't removed
+    * @param node to check
+    * @return true if node is present in this graph, false otherwise
+    */
+    bool has_node(node_handle const& node) const {
+        return node < nodes.size() && !removed_nodes[node];
+    }
+
+    /**
+    * Checks if given edge exists and neither it nor any of it's ends is removed
+    * @param edge to check
+    * @return true if edge is present in this graph, false otherwise
+    */
+    bool has_edge(edge_handle const& edge) const {
+        return edge < from.size() && !removed_edges[edge] && !removed_nodes[from[edge]] && !removed_nodes[to[edge]];
+    }
+
+    /**
+    * Returns number of nodes removed since the last compaction
+    * @return number of removed nodes
+    */
+    size_t get_removed_nodes_count() const {
+        return removed_nodes_count;
+    }
+
+    /**
+    * Returns number of edges explicitly removed since the last compaction
+    * @return number of removed edges
+    */
+    size_t get_removed_edges_count() const {
+        return removed_edges_count;
+    }
+
+    /**
+    * Rewrites storage contiguously dropping removed nodes and edges, including edges
+    * of removed nodes. Relative order of remaining nodes and edges is preserved.
+    * @return mapping from old handles to new ones
+    */
+    remapping_t compact() {
+        remapping_t remapping;
+        remapping.nodes.assign(nodes.size(), invalid_handle);
+        remapping.edges.assign(from.size(), invalid_handle);
+
+        size_t n = 0;
+        for (node_handle node = 0; node < nodes.size(); ++node) {
+            if (removed_nodes[node])
+                continue;
+            remapping.nodes[node] = n;
+            if (n != node)
+                payloads[n] = std::move(payloads[node]);
+            ++n;
+        }
+
+        size_t m = 0;
+        for (edge_handle edge = 0; edge < from.size(); ++edge) {
+            if (!has_edge(edge))
+                continue;
+            remapping.edges[edge] = m;
+            from[m] = remapping.nodes[from[edge]];
+            to[m] = remapping.nodes[to[edge]];
+            if (m != edge)
+                edge_payloads[m] = std::move(edge_payloads[edge]);
+            ++m;
+        }
+
+        payloads.resize(n);
+        from.resize(m);
+        to.resize(m);
+        edge_payloads.resize(m);
+        nodes.assign(n, std::vector<edge_handle>());
+        for (edge_handle edge = 0; edge < m; ++edge)
+            nodes[from[edge]].push_back(edge);
+        removed_nodes.assign(n, false);
+        removed_edges.assign(m, false);
+        removed_nodes_count = removed_edges_count = 0;
+        node_columns.remap(remapping.nodes, n);
+        edge_columns.remap(remapping.edges, m);
+
+        if (in_index_built.get()) {
+            drop_in_index();
+            build_in_index();
+        }
+        return remapping;
+    }
+
+    /**
+    * Compacts storage if share of removed nodes or share of removed edges exceeds given threshold.
+    * @param threshold share of removed nodes or edges in range [0, 1] which triggers compaction
+    * @return mapping from old handles to new ones, or empty mapping if compaction wasn't triggered
+    */
+    remapping_t compact(double threshold) {
+        if (removed_nodes_count > threshold * nodes.size() || removed_edges_count > threshold * from.size())
+            return compact();
+        return remapping_t();
+    }
+
+    /**
+    * Relabels nodes: node with handle i gets handle permutation[i] together with it's value,
+    * edges keep their handles and values. Use it with orderings from graph/reorder.h to place
+    * nodes which are visited together next to each other in memory.
+    * @param permutation new handle of each node
+    * @throws std::runtime_error if given vector isn't a permutation of node handles
+    */
+    void permute(std::vector<node_handle> const& permutation) {
+        size_t n = nodes.size();
+        if (permutation.size() != n)
+            throw std::runtime_error("permutation size doesn't match nodes count");
+        std::vector<bool> seen(n, false);
+        for (node_handle node : permutation) {
+            if (node >= n || seen[node])
+                throw std::runtime_error("given vector isn't a permutation");
+            seen[node] = true;
+        }
+
+        std::vector<std::vector<edge_handle>> permuted_nodes(n);
+        std::vector<T> permuted_payloads(n);
+        std::vector<bool> permuted_removed(n);
+        for (node_handle node = 0; node < n; ++node) {
+            node_handle target = permutation[node];
+            permuted_nodes[target].swap(nodes[node]);
+            permuted_payloads[target] = std::move(payloads[node]);
+            permuted_removed[target] = removed_nodes[node];
+        }
+        nodes.swap(permuted_nodes);
+        payloads.swap(permuted_payloads);
+        removed_nodes.swap(permuted_removed);
+        node_columns.remap(permutation, n);
+
+        for (edge_handle edge = 0; edge < from.size(); ++edge) {
+            from[edge] = permutation[from[edge]];
+            to[edge] = permutation[to[edge]];
+        }
+
+        if (in_index_built.get()) {
+            std::vector<std::vector<edge_handle>> permuted_in(n);
+            for (node_handle node = 0; node < n; ++node)
+                permuted_in[permutation[node]].swap(in_nodes[node]);
+            in_nodes.swap(permuted_in);
+        }
+    }
+
     /**
     * Execute given visitor on each node of this graph.
     * @tparam NodeVisitor type of node visitor
@@ -152,18 +559,28 @@ public:
     */
     template<typename NodeVisitor>
     void for_each_node(NodeVisitor visitor) const {
-        for (node_handle node = 0; node < nodes.size(); ++node)
-            visitor(node);
+        for (node_handle node = 0; node < nodes.size(); ++node) {
+            if (removed_nodes_count == 0 || !removed_nodes[node])
+                visitor(node);
+        }
     }
 
     /**
-    * Returns number of nodes in this graph
+    * Returns number of nodes handles in this graph, including removed nodes until compaction
     * @return numver of nodes in this graph
     */
     size_t get_nodes_count() const {
         return nodes.size();
     }
 
+    /**
+    * Returns number of edges in this graph
+    * @return number of edges in this graph
+    */
+    size_t get_edges_count() const {
+        return from.size();
+    }
+
     /**
     * Executes given visitor on each edge starting at the given node.
     * @param source node
@@ -172,18 +589,105 @@ public:
     */
     template<typename EdgeVisitor>
     void for_each_edge(node_handle const& source, EdgeVisitor visitor) {
-        for (edge_handle edge : nodes[source])
-            visitor(edge);
+        static_cast<graph_t const&>(*this).for_each_edge(source, visitor);
+    }
+
+    /**
+    * Executes given visitor on each edge starting at the given node.
+    * @param source node
+    * @param visitor to execute
+    * @tparam EdgeVisitor type of visitor
+    */
+    template<typename EdgeVisitor>
+    void for_each_edge(node_handle const& source, EdgeVisitor visitor) const {
+        if (removed_nodes_count == 0 && removed_edges_count == 0) {
+            for (edge_handle edge : nodes[source])
+                visitor(edge);
+            return;
+        }
+        if (removed_nodes[source])
+            return;
+        for (edge_handle edge : nodes[source]) {
+            if (!removed_edges[edge] && !removed_nodes[to[edge]])
+                visitor(edge);
+        }
+    }
+
+    /**
+    * Executes given visitor on each edge ending at the given node.
+    * Builds in-edge index on first call, after that the index is maintained by add_edge
+    * and each call takes time proportional to the in degree of the node.
+    * @param target node
+    * @param visitor to execute
+    * @tparam EdgeVisitor type of visitor
+    */
+    template<typename EdgeVisitor>
+    void for_each_in_edge(node_handle const& target, EdgeVisitor visitor) const {
+        build_in_index();
+        for (edge_handle edge : in_nodes[target]) {
+            if ((removed_nodes_count == 0 && removed_edges_count == 0) || has_edge(edge))
+                visitor(edge);
+        }
+    }
+
+    /**
+    * Builds in-edge index if it isn't built yet. Several threads may call it and for_each_in_edge
+    * on the same const graph at once: the first one builds the index under a lock, others wait for it.
+    */
+    void build_in_index() const {
+        if (in_index_built.get())
+            return;
+        std::lock_guard<std::mutex> lock(in_index_built.mutex());
+        if (in_index_built.get())
+            return;
+        in_nodes.assign(nodes.size(), std::vector<edge_handle>());
+        for (edge_handle edge = 0; edge < to.size(); ++edge)
+            in_nodes[to[edge]].push_back(edge);
+        in_index_built.set(true);
+    }
+
+    /**
+    * Releases memory of in-edge index, it will be rebuilt on the next for_each_in_edge call
+    */
+    void drop_in_index() {
+        std::vector<std::vector<edge_handle>>().swap(in_nodes);
+        in_index_built.set(false);
+    }
+
+    /**
+    * Checks if in-edge index is built
+    * @return true if in-edge index is built, false otherwise
+    */
+    bool has_in_index() const {
+        return in_index_built.get();
+    }
+
+    /**
+    * Returns start node of given edge
+    * @param edge
+    * @return start node of given edge
+    */
+    node_handle get_source(edge_handle const& edge) const {
+        return from[edge];
+    }
+
+    /**
+    * Returns end node of given edge
+    * @param edge
+    * @return end node of given edge
+    */
+    node_handle get_target(edge_handle const& edge) const {
+        return to[edge];
     }
 
     /**
     * Returns end node of given edge if it's start matches given origin
     * @param origin start of edge
     * @param edge to move along
-    * @throws std::runtime_error if given edge does not start at the given node
+    * @throws std::runtime_error if given edge does not start at the given node or is removed
     */
     node_handle move(node_handle const& origin, edge_handle const& edge) {
-        if (from[edge] != origin)
+        if (from[edge] != origin || !has_edge(edge))
             throw std::runtime_error("given edge doesn't start at the given origin");
         return to[edge];
     }
@@ -197,8 +701,146 @@ public:
         return payloads[node];
     }
 
+    /**
+    * Returns const reference to the value on given node
+    * @param node
+    * @return const reference to the value on given node
+    */
+    T const& operator[](node_handle const& node) const {
+        return payloads[node];
+    }
+
+    /**
+    * Returns reference to the value on given edge
+    * @param edge
+    * @return reference to the value on given edge
+    */
+    E & edge_payload(edge_handle const& edge) {
+        return edge_payloads[edge];
+    }
+
+    /**
+    * Returns const reference to the value on given edge
+    * @param edge
+    * @return const reference to the value on given edge
+    */
+    E const& edge_payload(edge_handle const& edge) const {
+        return edge_payloads[edge];
+    }
+
+    /**
+    * Adds named attribute with one value per node stored in it's own contiguous array.
+    * Values of new nodes are set to the initial value. Array is kept in sync by add_node, compact and permute.
+    * @param name of the attribute
+    * @param initial value of the attribute
+    * @tparam V type of values
+    * @return reference to array of values indexed by node handles, stays valid until the attribute is removed
+    * @throws std::runtime_error if attribute with given name already exists
+    */
+    template<typename V>
+    std::vector<V>& add_node_attribute(std::string const& name, V const& initial = V()) {
+        return node_columns.add(name, nodes.size(), initial);
+    }
+
+    /**
+    * Returns array of values of named node attribute
+    * @param name of the attribute
+    * @tparam V type of values
+    * @return reference to array of values indexed by node handles
+    * @throws std::runtime_error if attribute doesn't exist or has different type
+    */
+    template<typename V>
+    std::vector<V>& node_attribute(std::string const& name) {
+        return node_columns.get<V>(name);
+    }
+
+    /**
+    * Returns array of values of named node attribute
+    * @param name of the attribute
+    * @tparam V type of values
+    * @return const reference to array of values indexed by node handles
+    * @throws std::runtime_error if attribute doesn't exist or has different type
+    */
+    template<typename V>
+    std::vector<V> const& node_attribute(std::string const& name) const {
+        return node_columns.get<V>(name);
+    }
+
+    /**
+    * Checks if node attribute with given name exists
+    * @param name of the attribute
+    * @return true if attribute exists, false otherwise
+    */
+    bool has_node_attribute(std::string const& name) const {
+        return node_columns.contains(name);
+    }
+
+    /**
+    * Removes node attribute with given name if it exists
+    * @param name of the attribute
+    */
+    void remove_node_attribute(std::string const& name) {
+        node_columns.remove(name);
+    }
+
+    /**
+    * Adds named attribute with one value per edge stored in it's own contiguous array.
+    * Values of new edges are set to the initial value. Array is kept in sync by add_edge, add_edges and compact.
+    * @param name of the attribute
+    * @param initial value of the attribute
+    * @tparam V type of values
+    * @return reference to array of values indexed by edge handles, stays valid until the attribute is removed
+    * @throws std::runtime_error if attribute with given name already exists
+    */
+    template<typename V>
+    std::vector<V>& add_edge_attribute(std::string const& name, V const& initial = V()) {
+        return edge_columns.add(name, from.size(), initial);
+    }
+
+    /**
+    * Returns array of values of named edge attribute
+    * @param name of the attribute
+    * @tparam V type of values
+    * @return reference to array of values indexed by edge handles
+    * @throws std::runtime_error if attribute doesn't exist or has different type
+    */
+    template<typename V>
+    std::vector<V>& edge_attribute(std::string const& name) {
+        return edge_columns.get<V>(name);
+    }
+
+    /**
+    * Returns array of values of named edge attribute
+    * @param name of the attribute
+    * @tparam V type of values
+    * @return const reference to array of values indexed by edge handles
+    * @throws std::runtime_error if attribute doesn't exist or has different type
+    */
+    template<typename V>
+    std::vector<V> const& edge_attribute(std::string const& name) const {
+        return edge_columns.get<V>(name);
+    }
+
+    /**
+    * Checks if edge attribute with given name exists
+    * @param name of the attribute
+    * @return true if attribute exists, false otherwise
+    */
+    bool has_edge_attribute(std::string const& name) const {
+        return edge_columns.contains(name);
+    }
+
+    /**
+    * Removes edge attribute with given name if it exists
+    * @param name of the attribute
+    */
+    void remove_edge_attribute(std::string const& name) {
+        edge_columns.remove(name);
+    }
+
     /**
     * Depth first search. Visits each node and each edge which are reachable from given start node.
+    * Removed nodes and edges are skipped. Updates traversal_stats if GRAPH_STATS is defined.
     * @param start_node node to start dfs from
     * @param start_visitor to execute when algorithm enters a node
     * @param end_visitor to execute when algorithm leaves a node
@@ -209,40 +851,129 @@ public:
     * @see http://en.wikipedia.org/wiki/Depth-first_search
     */
     template<typename StartVisitor, typename EndVisitor, typename DiscoverVisitor>
-    void dfs(node_handle start_node, StartVisitor start_visitor, EndVisitor end_visitor, DiscoverVisitor discover_visitor) {
-        if (nodes.empty())
+    void dfs(node_handle start_node, StartVisitor start_visitor, EndVisitor end_visitor, DiscoverVisitor discover_visitor) const {
+        if (!has_node(start_node))
             return;
 
-        std::stack<std::pair<node_handle, size_t>> way;
+        std::vector<std::pair<node_handle, size_t>> way;
         std::vector<bool> used(nodes.size());
+        GRAPH_STATS_ADD(allocations, 1);
 
-        way.push(std::make_pair(start_node, 0));
+        graph_detail::tracked_push(way, std::make_pair(start_node, size_t(0)));
         while (!way.empty()) {
-            auto& top = way.top();
+            auto& top = way.back();
             node_handle node = top.first;
             if (!used[node]) {
                 used[node] = true;
+                GRAPH_STATS_ADD(nodes_visited, 1);
                 start_visitor(node);
             }
             size_t i = top.second++;
             if (i == nodes[node].size()) {
-                way.pop();
+                way.pop_back();
                 end_visitor(node);
                 continue;
             }
             edge_handle e = nodes[node][i];
+            if ((removed_nodes_count != 0 || removed_edges_count != 0) && !has_edge(e))
+                continue;
+            GRAPH_STATS_ADD(edges_scanned, 1);
             node_handle next = to[e];
             discover_visitor(next);
             if (used[next])
                 continue;
-            way.push(std::make_pair(next, 0));
+            graph_detail::tracked_push(way, std::make_pair(next, size_t(0)));
+            GRAPH_STATS_MAX(max_frontier, way.size());
+        }
+    }
+
+    /**
+    * Breadth first search. Visits each node and each edge which are reachable from given start node
+    * in order of increasing number of edges from the start node. Removed nodes and edges are skipped.
+    * Updates traversal_stats if GRAPH_STATS is defined.
+    * @param start_node node to start bfs from
+    * @param start_visitor to execute when algorithm enters a node
+    * @param discover_visitor to execute when algorithm discovers a node
+    * @tparam StartVisitor type of start_visitor
+    * @tparam DiscoverVisitor type of discover_visitor
+    * @see http://en.wikipedia.org/wiki/Breadth-first_search
+    */
+    template<typename StartVisitor, typename DiscoverVisitor>
+    void bfs(node_handle start_node, StartVisitor start_visitor, DiscoverVisitor discover_visitor) const {
+        if (!has_node(start_node))
+            return;
+
+        std::vector<node_handle> queue;
+        std::vector<bool> used(nodes.size());
+        GRAPH_STATS_ADD(allocations, 1);
+
+        used[start_node] = true;
+        graph_detail::tracked_push(queue, start_node);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            node_handle node = queue[head];
+            GRAPH_STATS_ADD(nodes_visited, 1);
+            GRAPH_STATS_MAX(max_frontier, queue.size() - head);
+            start_visitor(node);
+            for_each_edge(node, [&](edge_handle const& edge) {
+                GRAPH_STATS_ADD(edges_scanned, 1);
+                node_handle next = to[edge];
+                discover_visitor(next);
+                if (used[next])
+                    return;
+                used[next] = true;
+                graph_detail::tracked_push(queue, next);
+            });
         }
     }
 
 private:
+    static const size_t min_parallel_edges = 65536;
+
+    template<typename A, typename B>
+    static node_handle source_of(std::pair<A, B> const& edge) {
+        return edge.first;
+    }
+
+    template<typename A, typename B>
+    static node_handle target_of(std::pair<A, B> const& edge) {
+        return edge.second;
+    }
+
+    template<typename A, typename B>
+    static E value_of(std::pair<A, B> const&) {
+        return E();
+    }
+
+    template<typename A, typename B, typename C>
+    static node_handle source_of(std::tuple<A, B, C> const& edge) {
+        return std::get<0>(edge);
+    }
+
+    template<typename A, typename B, typename C>
+    static node_handle target_of(std::tuple<A, B, C> const& edge) {
+        return std::get<1>(edge);
+    }
+
+    template<typename A, typename B, typename C>
+    static E value_of(std::tuple<A, B, C> const& edge) {
+        return std::get<2>(edge);
+    }
+
     std::vector<std::vector<edge_handle>> nodes;
     std::vector<T> payloads;
 
     std::vector<node_handle> from;
     std::vector<node_handle> to;
+    std::vector<E> edge_payloads;
+
+    mutable std::vector<std::vector<edge_handle>> in_nodes;
+    mutable graph_detail::build_flag in_index_built;
+
+    std::vector<bool> removed_nodes;
+    std::vector<bool> removed_edges;
+    size_t removed_nodes_count = 0;
+    size_t removed_edges_count = 0;
+
+    graph_detail::column_set node_columns;
+    graph_detail::column_set edge_columns;
 };
\ No newline at end of file
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+namespace graph_detail {
+    /**
+    * Type-erased array of attribute values
+    */
+    class column_base {
+    public:
+        virtual ~column_base() = default;
+        virtual column_base* clone() const = 0;
+        virtual void resize(size_t n) = 0;
+        virtual void remap(std::vector<size_t> const& mapping, size_t n) = 0;
+    };
+
+    template<typename V>
+    class column : public column_base {
+    public:
+        column(size_t n, V const& initial)
+            : values(n, initial)
+            , initial(initial)
+        {}
+
+        column_base* clone() const {
+            return new column(*this);
+        }
+
+        void resize(size_t n) {
+            values.resize(n, initial);
+        }
+
+        void remap(std::vector<size_t> const& mapping, size_t n) {
+            std::vector<V> remapped(n, initial);
+            for (size_t i = 0; i < mapping.size(); ++i) {
+                if (mapping[i] != static_cast<size_t>(-1))
+                    remapped[mapping[i]] = std::move(values[i]);
+            }
+            values.swap(remapped);
+        }
+
+        std::vector<V> values;
+        V initial;
+    };
+
+    /**
+    * Named typed attribute arrays of equal length, one value per node or per edge.
+    * Each attribute is stored in it's own contiguous array, so algorithms reading one attribute
+    * don't pull other ones through cache. Copying the set copies all arrays.
+    */
+    class column_set {
+    public:
+        column_set() = default;
+
+        column_set(column_set const& origin) {
+            for (auto const& entry : origin.columns) {
+                std::unique_ptr<column_base> copy(entry.second->clone());
+                columns.insert(std::make_pair(entry.first, std::move(copy)));
+            }
+        }
+
+        column_set(column_set && origin)
+            : columns(std::move(origin.columns))
+        {}
+
+        column_set& operator=(column_set origin) {
+            std::swap(columns, origin.columns);
+            return *this;
+        }
+
+        template<typename V>
+        std::vector<V>& add(std::string const& name, size_t n, V const& initial) {
+            if (contains(name))
+                throw std::runtime_error("attribute '" + name + "' already exists");
+            column<V>* created = new column<V>(n, initial);
+            std::unique_ptr<column_base> owner(created);
+            columns.insert(std::make_pair(name, std::move(owner)));
+            return created->values;
+        }
+
+        template<typename V>
+        std::vector<V>& get(std::string const& name) {
+            return const_cast<column<V>&>(find<V>(name)).values;
+        }
+
+        template<typename V>
+        std::vector<V> const& get(std::string const& name) const {
+            return find<V>(name).values;
+        }
+
+        bool contains(std::string const& name) const {
+            return columns.count(name) != 0;
+        }
+
+        void remove(std::string const& name) {
+            columns.erase(name);
+        }
+
+        void resize(size_t n) {
+            for (auto& entry : columns)
+                entry.second->resize(n);
+        }
+
+        void remap(std::vector<size_t> const& mapping, size_t n) {
+            for (auto& entry : columns)
+                entry.second->remap(mapping, n);
+        }
+
+        void clear() {
+            columns.clear();
+        }
+
+    private:
+        template<typename V>
+        column<V> const& find(std::string const& name) const {
+            auto it = columns.find(name);
+            if (it == columns.end())
+                throw std::runtime_error("attribute '" + name + "' doesn't exist");
+            column<V> const* typed = dynamic_cast<column<V> const*>(it->second.get());
+            if (typed == nullptr)
+                throw std::runtime_error("attribute '" + name + "' has different type");
+            return *typed;
+        }
+
+        std::map<std::string, std::unique_ptr<column_base>> columns;
+    };
+}
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+
+#include <graph.h>
+#include <graph/csr.h>
+#include <graph/parallel.h>
+
+/**
+* Partition of graph nodes into components
+*/
+struct components_t {
+    /**
+    * Component id of each node
+    */
+    std::vector<size_t> component;
+
+    /**
+    * Number of components, ids are in range [0, count)
+    */
+    size_t count = 0;
+};
+
+/**
+* Finds strongly connected components using iterative Tarjan's algorithm.
+* Components are numbered in topological order: each edge between different components
+* goes from component with lower id to component with greater id.
+* @param csr snapshot of the graph
+* @return strongly connected components
+* @see http://en.wikipedia.org/wiki/Tarjan%27s_strongly_connected_components_algorithm
+*/
+inline components_t strongly_connected_components(csr_t const& csr) {
+    size_t n = csr.get_nodes_count();
+    components_t result;
+    result.component.assign(n, invalid_handle);
+
+    std::vector<size_t> index(n, invalid_handle);
+    std::vector<size_t> low(n, 0);
+    std::vector<size_t> open;
+    std::vector<size_t> way_nodes;
+    std::vector<size_t> way_edges;
+    size_t counter = 0;
+
+    for (size_t root = 0; root < n; ++root) {
+        if (index[root] != invalid_handle)
+            continue;
+
+        index[root] = low[root] = counter++;
+        open.push_back(root);
+        way_nodes.push_back(root);
+        way_edges.push_back(csr.begin(root));
+        while (!way_nodes.empty()) {
+            size_t node = way_nodes.back();
+            size_t i = way_edges.back();
+            if (i < csr.end(node)) {
+                ++way_edges.back();
+                size_t next = csr.get_target(i);
+                if (index[next] == invalid_handle) {
+                    index[next] = low[next] = counter++;
+                    open.push_back(next);
+                    way_nodes.push_back(next);
+                    way_edges.push_back(csr.begin(next));
+                } else if (result.component[next] == invalid_handle) {
+                    low[node] = std::min(low[node], index[next]);
+                }
+                continue;
+            }
+
+            way_nodes.pop_back();
+            way_edges.pop_back();
+            if (!way_nodes.empty()) {
+                size_t parent = way_nodes.back();
+                low[parent] = std::min(low[parent], low[node]);
+            }
+            if (low[node] == index[node]) {
+                size_t member;
+                do {
+                    member = open.back();
+                    open.pop_back();
+                    result.component[member] = result.count;
+                } while (member != node);
+                ++result.count;
+            }
+        }
+    }
+
+    for (size_t& component : result.component)
+        component = result.count - 1 - component;
+    return result;
+}
+
+/**
+* Finds strongly connected components using iterative Tarjan's algorithm.
+* @param graph to search in
+* @return strongly connected components numbered in topological order
+*/
+template<typename T, typename E>
+components_t strongly_connected_components(graph_t<T, E> const& graph) {
+    return strongly_connected_components(csr_t(graph));
+}
+
+/**
+* Builds condensation of the graph: one node per component holding handles of it's members,
+* and one edge for each pair of components connected by at least one edge.
+* @param csr snapshot of the graph
+* @param components of the graph, e.g. strongly connected ones
+* @return condensation graph, node handles are equal to component ids
+*/
+inline graph_t<std::vector<size_t>> condensation(csr_t const& csr, components_t const& components) {
+    graph_t<std::vector<size_t>> result;
+    for (size_t i = 0; i < components.count; ++i)
+        result.add_node();
+    for (size_t node = 0; node < csr.get_nodes_count(); ++node)
+        result[components.component[node]].push_back(node);
+
+    std::vector<size_t> linked(components.count, invalid_handle);
+    for (size_t source = 0; source < components.count; ++source) {
+        for (size_t node : result[source]) {
+            for (size_t i = csr.begin(node); i < csr.end(node); ++i) {
+                size_t target = components.component[csr.get_target(i)];
+                if (target == source || linked[target] == source)
+                    continue;
+                linked[target] = source;
+                result.add_edge(source, target);
+            }
+        }
+    }
+    return result;
+}
+
+/**
+* Builds condensation of the graph by it's strongly connected components.
+* @param graph to condense
+* @return condensation graph, node handles are equal to component ids
+*/
+template<typename T, typename E>
+graph_t<std::vector<size_t>> condensation(graph_t<T, E> const& graph) {
+    csr_t csr(graph);
+    return condensation(csr, strongly_connected_components(csr));
+}
+
+/**
+* Orders nodes so that each edge goes from earlier node to later one using iterative depth first search.
+* @param csr snapshot of the graph
+* @return nodes in topological order
+* @throws std::runtime_error if graph contains a cycle
+* @see http://en.wikipedia.org/wiki/Topological_sorting
+*/
+inline std::vector<size_t> topological_sort(csr_t const& csr) {
+    enum state_t : unsigned char {
+        NEW,
+        OPEN,
+        CLOSED
+    };
+
+    size_t n = csr.get_nodes_count();
+    std::vector<size_t> order(n);
+    size_t position = n;
+    std::vector<state_t> state(n, NEW);
+    std::vector<size_t> way_nodes;
+    std::vector<size_t> way_edges;
+
+    for (size_t root = 0; root < n; ++root) {
+        if (state[root] != NEW)
+            continue;
+
+        state[root] = OPEN;
+        way_nodes.push_back(root);
+        way_edges.push_back(csr.begin(root));
+        while (!way_nodes.empty()) {
+            size_t node = way_nodes.back();
+            size_t i = way_edges.back();
+            if (i < csr.end(node)) {
+                ++way_edges.back();
+                size_t next = csr.get_target(i);
+                if (state[next] == OPEN)
+                    throw std::runtime_error("graph contains a cycle");
+                if (state[next] == NEW) {
+                    state[next] = OPEN;
+                    way_nodes.push_back(next);
+                    way_edges.push_back(csr.begin(next));
+                }
+                continue;
+            }
+            way_nodes.pop_back();
+            way_edges.pop_back();
+            state[node] = CLOSED;
+            order[--position] = node;
+        }
+    }
+    return order;
+}
+
+/**
+* Orders nodes so that each edge goes from earlier node to later one.
+* @param graph to sort
+* @return nodes in topological order
+* @throws std::runtime_error if graph contains a cycle
+*/
+template<typename T, typename E>
+std::vector<size_t> topological_sort(graph_t<T, E> const& graph) {
+    return topological_sort(csr_t(graph));
+}
+
+namespace graph_detail {
+    /**
+    * Disjoint set forest which may be updated by several threads at once.
+    * Roots are linked by compare-and-swap from greater handle to lesser one, so links never form cycles,
+    * and finds halve paths with plain stores, which is benign under races since any stored value is an ancestor.
+    */
+    class concurrent_union_find {
+    public:
+        explicit concurrent_union_find(size_t n)
+            : parent(n)
+        {
+            for (size_t i = 0; i < n; ++i)
+                parent[i].store(i, std::memory_order_relaxed);
+        }
+
+        size_t find(size_t node) {
+            size_t current = parent[node].load(std::memory_order_relaxed);
+            while (current != node) {
+                size_t next = parent[current].load(std::memory_order_relaxed);
+                if (next != current)
+                    parent[node].store(next, std::memory_order_relaxed);
+                node = current;
+                current = next;
+            }
+            return node;
+        }
+
+        void unite(size_t a, size_t b) {
+            while (true) {
+                a = find(a);
+                b = find(b);
+                if (a == b)
+                    return;
+                if (a < b)
+                    std::swap(a, b);
+                size_t expected = a;
+                if (parent[a].compare_exchange_weak(expected, b, std::memory_order_relaxed))
+                    return;
+            }
+        }
+
+    private:
+        std::vector<std::atomic<size_t>> parent;
+    };
+}
+
+/**
+* Finds weakly connected components: components of the graph with edges treated as undirected.
+* Runs concurrent union-find over edges split between threads by edge count. As in Afforest, the first
+* edge of each node is processed in a separate round followed by path compression, so most later edges
+* find both ends already in one shallow tree and are skipped without any write.
+* @param csr snapshot of the graph
+* @param threads maximum number of threads to use
+* @return components numbered in order of their least node
+* @see http://en.wikipedia.org/wiki/Disjoint-set_data_structure
+*/
+inline components_t weakly_connected_components(csr_t const& csr, size_t threads = graph_detail::default_threads()) {
+    size_t n = csr.get_nodes_count();
+    graph_detail::concurrent_union_find forest(n);
+    static const size_t min_part = 16384;
+    size_t parts = std::max<size_t>(1, std::min(threads, (n + csr.get_edges_count()) / min_part));
+    std::vector<size_t> bounds = graph_detail::partition_by_edges(csr.get_offsets(), parts);
+
+    graph_detail::parallel_for_ranges(bounds, [&](size_t, size_t lo, size_t hi) {
+        for (size_t node = lo; node < hi; ++node) {
+            if (csr.begin(node) != csr.end(node))
+                forest.unite(node, csr.get_target(csr.begin(node)));
+        }
+    });
+    graph_detail::parallel_for_ranges(bounds, [&](size_t, size_t lo, size_t hi) {
+        for (size_t node = lo; node < hi; ++node)
+            forest.find(node);
+    });
+    graph_detail::parallel_for_ranges(bounds, [&](size_t, size_t lo, size_t hi) {
+        for (size_t node = lo; node < hi; ++node) {
+            for (size_t i = csr.begin(node) + 1; i < csr.end(node); ++i)
+                forest.unite(node, csr.get_target(i));
+        }
+    });
+
+    components_t result;
+    result.component.assign(n, invalid_handle);
+    for (size_t node = 0; node < n; ++node) {
+        size_t root = forest.find(node);
+        if (result.component[root] == invalid_handle)
+            result.component[root] = result.count++;
+        result.component[node] = result.component[root];
+    }
+    return result;
+}
+
+/**
+* Finds weakly connected components: components of the graph with edges treated as undirected.
+* @param graph to search in
+* @param threads maximum number of threads to use
+* @return components numbered in order of their least node
+*/
+template<typename T, typename E>
+components_t weakly_connected_components(graph_t<T, E> const& graph, size_t threads = graph_detail::default_threads()) {
+    return weakly_connected_components(csr_t(graph), threads);
+}
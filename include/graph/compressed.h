@@ -0,0 +1,327 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <stdint.h>
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+
+#include <graph.h>
+
+namespace graph_detail {
+    inline void write_varint(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    inline uint64_t read_varint(uint8_t const*& in) {
+        uint64_t value = *in++;
+        if (value < 0x80)
+            return value;
+        value &= 0x7f;
+        for (unsigned shift = 7; ; shift += 7) {
+            uint64_t byte = *in++;
+            value |= (byte & 0x7f) << shift;
+            if (byte < 0x80)
+                return value;
+        }
+    }
+
+    inline uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    inline int64_t unzigzag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+}
+
+/**
+* Read-only graph with compressed adjacency for graphs too large for graph_t.
+* Out-neighbours of each node are sorted and stored as a byte-aligned varint stream:
+* degree, then first neighbour as zigzag-encoded difference with the node itself,
+* then gaps between consecutive neighbours. Graphs with good locality, e.g. after
+* reordering from graph/reorder.h, take one or two bytes per edge. Lists are decoded on the fly
+* by traversals. Edge values are not kept and edges have no identity of their own: for_each_edge passes
+* the end node as the edge handle and get_target returns it, so the graph can be passed wherever
+* get_nodes_count(), for_each_edge(node, visitor) and get_target(edge) are expected, e.g. to csr_t.
+* @tparam Handle type of node handles, e.g. uint32_t to halve memory of handles
+* @tparam Offset type of positions of node lists in the byte stream, the stream may be at most
+*         as long as it's maximum value, so graphs with more than 4 GiB of adjacency need uint64_t
+*/
+template<typename Handle = uint32_t, typename Offset = Handle>
+class compressed_graph_t {
+public:
+    typedef Handle node_handle;
+    typedef Handle edge_handle;
+
+    /**
+    * Constructs empty graph
+    */
+    compressed_graph_t()
+        : offsets(1, 0)
+        , edges_count(0)
+    {}
+
+    /**
+    * Compresses given graph
+    * @param graph to compress, graph_t or any type providing
+    *        get_nodes_count(), for_each_edge(node, visitor) and get_target(edge)
+    * @tparam Graph type of graph
+    * @throws std::runtime_error if nodes count doesn't fit into Handle or adjacency doesn't fit into Offset
+    */
+    template<typename Graph>
+    explicit compressed_graph_t(Graph const& graph)
+        : offsets(1, 0)
+        , edges_count(0)
+    {
+        size_t n = graph.get_nodes_count();
+        check_nodes_count(n);
+
+        offsets.reserve(n + 1);
+        std::vector<Handle> neighbours;
+        for (size_t node = 0; node < n; ++node) {
+            graph.for_each_edge(node, [&graph, &neighbours](size_t edge) {
+                neighbours.push_back(static_cast<Handle>(graph.get_target(edge)));
+            });
+            append(node, neighbours);
+        }
+        bytes.shrink_to_fit();
+    }
+
+    /**
+    * Builds graph with given number of nodes from a stream of edges ordered by source node,
+    * without materializing graph_t. Edges are read in one pass, so input iterators like
+    * std::istream_iterator work, and only out-neighbours of the current node are buffered.
+    * Targets of one source may come in any order.
+    * @param n number of nodes
+    * @param first iterator to the first edge, std::pair<size_t, size_t> or std::tuple starting with source and target
+    * @param last iterator past the last edge
+    * @tparam EdgeIterator type of iterators
+    * @return built graph
+    * @throws std::runtime_error if nodes count doesn't fit into Handle, adjacency doesn't fit into Offset,
+    *         any edge end doesn't exist or edges aren't ordered by source
+    */
+    template<typename EdgeIterator>
+    static compressed_graph_t from_sorted_edges(size_t n, EdgeIterator first, EdgeIterator last) {
+        check_nodes_count(n);
+
+        compressed_graph_t graph;
+        graph.offsets.reserve(n + 1);
+        std::vector<Handle> neighbours;
+        size_t node = 0;
+        for (; first != last; ++first) {
+            auto const& edge = *first;
+            size_t source = std::get<0>(edge);
+            size_t target = std::get<1>(edge);
+            if (source >= n || target >= n)
+                throw std::runtime_error("edge end doesn't exist");
+            if (source < node)
+                throw std::runtime_error("edges aren't ordered by source");
+            for (; node < source; ++node)
+                graph.append(node, neighbours);
+            neighbours.push_back(static_cast<Handle>(target));
+        }
+        for (; node < n; ++node)
+            graph.append(node, neighbours);
+        graph.bytes.shrink_to_fit();
+        return graph;
+    }
+
+    /**
+    * Returns number of nodes in this graph
+    * @return number of nodes
+    */
+    size_t get_nodes_count() const {
+        return offsets.size() - 1;
+    }
+
+    /**
+    * Returns number of edges in this graph
+    * @return number of edges
+    */
+    size_t get_edges_count() const {
+        return edges_count;
+    }
+
+    /**
+    * Returns number of bytes taken by adjacency data, including offsets
+    * @return size of adjacency data in bytes
+    */
+    size_t get_bytes_count() const {
+        return bytes.size() + offsets.size() * sizeof(Offset);
+    }
+
+    /**
+    * Returns out degree of given node
+    * @param node
+    * @return number of edges starting at the node
+    */
+    size_t get_degree(node_handle node) const {
+        uint8_t const* in = bytes.data() + offsets[node];
+        return graph_detail::read_varint(in);
+    }
+
+    /**
+    * Executes given visitor on end node of each edge starting at the given node, in increasing order.
+    * @param source node
+    * @param visitor to execute
+    * @tparam NeighbourVisitor type of visitor
+    */
+    template<typename NeighbourVisitor>
+    void for_each_neighbour(node_handle source, NeighbourVisitor visitor) const {
+        cursor_t cursor = open(source);
+        while (cursor.remaining != 0)
+            visitor(next(cursor));
+    }
+
+    /**
+    * Executes given visitor on each edge starting at the given node, in increasing order of end nodes.
+    * Edge handle is the end node of the edge.
+    * @param source node
+    * @param visitor to execute
+    * @tparam EdgeVisitor type of visitor
+    */
+    template<typename EdgeVisitor>
+    void for_each_edge(node_handle source, EdgeVisitor visitor) const {
+        for_each_neighbour(source, visitor);
+    }
+
+    /**
+    * Returns end node of given edge
+    * @param edge handle passed by for_each_edge
+    * @return end node of the edge
+    */
+    node_handle get_target(edge_handle edge) const {
+        return edge;
+    }
+
+    /**
+    * Depth first search, see graph_t::dfs. Stack entries hold decoder positions, so adjacency
+    * is decoded lazily as the search advances.
+    * @param start_node node to start dfs from
+    * @param start_visitor to execute when algorithm enters a node
+    * @param end_visitor to execute when algorithm leaves a node
+    * @param discover_visitor to execute when algorithm discovers a node
+    */
+    template<typename StartVisitor, typename EndVisitor, typename DiscoverVisitor>
+    void dfs(node_handle start_node, StartVisitor start_visitor, EndVisitor end_visitor, DiscoverVisitor discover_visitor) const {
+        if (static_cast<size_t>(start_node) >= get_nodes_count())
+            return;
+
+        std::vector<cursor_t> way;
+        std::vector<bool> used(get_nodes_count());
+        used[start_node] = true;
+        start_visitor(start_node);
+        way.push_back(open(start_node));
+        while (!way.empty()) {
+            cursor_t& top = way.back();
+            if (top.remaining == 0) {
+                node_handle node = top.node;
+                way.pop_back();
+                end_visitor(node);
+                continue;
+            }
+            node_handle next_node = next(top);
+            discover_visitor(next_node);
+            if (used[next_node])
+                continue;
+            used[next_node] = true;
+            start_visitor(next_node);
+            way.push_back(open(next_node));
+        }
+    }
+
+    /**
+    * Breadth first search, see graph_t::bfs. Adjacency of each node is decoded when it leaves the queue.
+    * @param start_node node to start bfs from
+    * @param start_visitor to execute when algorithm enters a node
+    * @param discover_visitor to execute when algorithm discovers a node
+    */
+    template<typename StartVisitor, typename DiscoverVisitor>
+    void bfs(node_handle start_node, StartVisitor start_visitor, DiscoverVisitor discover_visitor) const {
+        if (static_cast<size_t>(start_node) >= get_nodes_count())
+            return;
+
+        std::vector<node_handle> queue;
+        std::vector<bool> used(get_nodes_count());
+        used[start_node] = true;
+        queue.push_back(start_node);
+        for (size_t head = 0; head < queue.size(); ++head) {
+            node_handle node = queue[head];
+            start_visitor(node);
+            cursor_t cursor = open(node);
+            while (cursor.remaining != 0) {
+                node_handle next_node = next(cursor);
+                discover_visitor(next_node);
+                if (used[next_node])
+                    continue;
+                used[next_node] = true;
+                queue.push_back(next_node);
+            }
+        }
+    }
+
+private:
+    static void check_nodes_count(size_t n) {
+        if (n > static_cast<size_t>(std::numeric_limits<Handle>::max()))
+            throw std::runtime_error("nodes count doesn't fit into handle type");
+    }
+
+    /**
+    * Encodes out-neighbours of the next node and clears them
+    */
+    void append(size_t node, std::vector<Handle>& neighbours) {
+        std::sort(neighbours.begin(), neighbours.end());
+        graph_detail::write_varint(bytes, neighbours.size());
+        if (!neighbours.empty()) {
+            graph_detail::write_varint(bytes, graph_detail::zigzag(
+                    static_cast<int64_t>(neighbours[0]) - static_cast<int64_t>(node)));
+            for (size_t i = 1; i < neighbours.size(); ++i)
+                graph_detail::write_varint(bytes, neighbours[i] - neighbours[i - 1]);
+        }
+        if (bytes.size() > static_cast<uint64_t>(std::numeric_limits<Offset>::max()))
+            throw std::runtime_error("adjacency doesn't fit into offset type");
+        edges_count += neighbours.size();
+        offsets.push_back(static_cast<Offset>(bytes.size()));
+        neighbours.clear();
+    }
+
+    struct cursor_t {
+        uint8_t const* in;
+        size_t remaining;
+        int64_t previous;
+        bool first;
+        node_handle node;
+    };
+
+    cursor_t open(node_handle node) const {
+        cursor_t cursor;
+        cursor.in = bytes.data() + offsets[node];
+        cursor.remaining = graph_detail::read_varint(cursor.in);
+        cursor.previous = static_cast<int64_t>(node);
+        cursor.first = true;
+        cursor.node = node;
+        return cursor;
+    }
+
+    node_handle next(cursor_t& cursor) const {
+        uint64_t value = graph_detail::read_varint(cursor.in);
+        if (cursor.first) {
+            cursor.previous += graph_detail::unzigzag(value);
+            cursor.first = false;
+        } else {
+            cursor.previous += static_cast<int64_t>(value);
+        }
+        --cursor.remaining;
+        return static_cast<node_handle>(cursor.previous);
+    }
+
+    std::vector<uint8_t> bytes;
+    std::vector<Offset> offsets;
+    size_t edges_count;
+};
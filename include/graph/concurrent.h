@@ -0,0 +1,354 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <stdexcept>
+
+#include <graph.h>
+
+namespace graph_detail {
+    /**
+    * Append-only array of geometrically growing segments. Elements never move,
+    * so references to them stay valid while other threads append.
+    * @tparam V type of elements, must be default constructible
+    */
+    template<typename V>
+    class segmented_array {
+    public:
+        segmented_array() {
+            for (std::atomic<V*>& segment : segments)
+                segment.store(nullptr, std::memory_order_relaxed);
+        }
+
+        segmented_array(segmented_array const&) = delete;
+        segmented_array& operator=(segmented_array const&) = delete;
+
+        ~segmented_array() {
+            for (std::atomic<V*>& segment : segments)
+                delete[] segment.load(std::memory_order_relaxed);
+        }
+
+        /**
+        * Returns element with given index allocating it's segment if needed
+        * @param index of element
+        * @return reference to the element
+        */
+        V& ensure(size_t index) {
+            size_t segment = segment_of(index);
+            V* data = segments[segment].load(std::memory_order_acquire);
+            if (data == nullptr) {
+                V* allocated = new V[base << segment];
+                if (segments[segment].compare_exchange_strong(data, allocated, std::memory_order_acq_rel))
+                    data = allocated;
+                else
+                    delete[] allocated;
+            }
+            return data[index - base * ((size_t(1) << segment) - 1)];
+        }
+
+        /**
+        * Returns pointer to element with given index or nullptr if it's segment isn't allocated yet
+        * @param index of element
+        * @return pointer to the element or nullptr
+        */
+        V* find(size_t index) const {
+            size_t segment = segment_of(index);
+            V* data = segments[segment].load(std::memory_order_acquire);
+            return data == nullptr ? nullptr : data + (index - base * ((size_t(1) << segment) - 1));
+        }
+
+        /**
+        * Returns element with given index which segment is already allocated
+        * @param index of element
+        * @return reference to the element
+        */
+        V& operator[](size_t index) const {
+            size_t segment = segment_of(index);
+            return segments[segment].load(std::memory_order_acquire)[index - base * ((size_t(1) << segment) - 1)];
+        }
+
+    private:
+        static const size_t base = 1024;
+        static const size_t segments_count = 48;
+
+        static size_t segment_of(size_t index) {
+            return 63 - __builtin_clzll(index / base + 1);
+        }
+
+        std::atomic<V*> segments[segments_count];
+    };
+}
+
+/**
+* Oriented graph supporting concurrent lock-free appends of nodes and edges while other threads
+* traverse consistent snapshots of it. Nodes and edges can't be changed or removed once added.
+* Each element gets it's handle at the start of append and becomes visible to new snapshots when
+* it and all elements with lesser handles are completely written, so a snapshot is described by
+* just two numbers and taking it doesn't copy anything.
+* @tparam T type of values on nodes
+* @tparam E type of values on edges
+*/
+template<typename T, typename E = no_value>
+class concurrent_graph_t {
+    struct node_t {
+        T payload;
+        std::atomic<size_t> head;
+        std::atomic<bool> ready;
+
+        node_t()
+            : head(invalid_handle)
+            , ready(false)
+        {}
+    };
+
+    struct edge_t {
+        size_t from;
+        size_t to;
+        size_t next;
+        E payload;
+        std::atomic<bool> ready;
+
+        edge_t()
+            : ready(false)
+        {}
+    };
+
+public:
+    typedef size_t node_handle;
+    typedef size_t edge_handle;
+
+    /**
+    * Consistent read-only view of the graph at the moment it was taken.
+    * Remains valid while the graph exists and isn't affected by later appends.
+    */
+    class snapshot_t {
+    public:
+        /**
+        * Returns number of nodes in this snapshot
+        * @return number of nodes
+        */
+        size_t get_nodes_count() const {
+            return nodes_count;
+        }
+
+        /**
+        * Returns number of edges in this snapshot
+        * @return number of edges
+        */
+        size_t get_edges_count() const {
+            return edges_count;
+        }
+
+        /**
+        * Execute given visitor on each node of this snapshot.
+        * @tparam NodeVisitor type of node visitor
+        * @param visitor to execute
+        */
+        template<typename NodeVisitor>
+        void for_each_node(NodeVisitor visitor) const {
+            for (node_handle node = 0; node < nodes_count; ++node)
+                visitor(node);
+        }
+
+        /**
+        * Executes given visitor on each edge of this snapshot starting at the given node,
+        * most recently added edges first.
+        * @param source node
+        * @param visitor to execute
+        * @tparam EdgeVisitor type of visitor
+        */
+        template<typename EdgeVisitor>
+        void for_each_edge(node_handle const& source, EdgeVisitor visitor) const {
+            size_t edge = graph->nodes[source].head.load(std::memory_order_acquire);
+            while (edge != invalid_handle) {
+                edge_t const& record = graph->edges[edge];
+                if (edge < edges_count)
+                    visitor(edge);
+                edge = record.next;
+            }
+        }
+
+        /**
+        * Returns start node of given edge
+        * @param edge
+        * @return start node of given edge
+        */
+        node_handle get_source(edge_handle const& edge) const {
+            return graph->edges[edge].from;
+        }
+
+        /**
+        * Returns end node of given edge
+        * @param edge
+        * @return end node of given edge
+        */
+        node_handle get_target(edge_handle const& edge) const {
+            return graph->edges[edge].to;
+        }
+
+        /**
+        * Returns const reference to the value on given node
+        * @param node
+        * @return const reference to the value on given node
+        */
+        T const& operator[](node_handle const& node) const {
+            return graph->nodes[node].payload;
+        }
+
+        /**
+        * Returns const reference to the value on given edge
+        * @param edge
+        * @return const reference to the value on given edge
+        */
+        E const& edge_payload(edge_handle const& edge) const {
+            return graph->edges[edge].payload;
+        }
+
+        /**
+        * Depth first search over this snapshot, see graph_t::dfs
+        * @param start_node node to start dfs from
+        * @param start_visitor to execute when algorithm enters a node
+        * @param end_visitor to execute when algorithm leaves a node
+        * @param discover_visitor to execute when algorithm discovers a node
+        */
+        template<typename StartVisitor, typename EndVisitor, typename DiscoverVisitor>
+        void dfs(node_handle start_node, StartVisitor start_visitor, EndVisitor end_visitor, DiscoverVisitor discover_visitor) const {
+            if (start_node >= nodes_count)
+                return;
+
+            std::vector<std::pair<node_handle, size_t>> way;
+            std::vector<bool> used(nodes_count);
+
+            used[start_node] = true;
+            start_visitor(start_node);
+            way.push_back(std::make_pair(start_node, graph->nodes[start_node].head.load(std::memory_order_acquire)));
+            while (!way.empty()) {
+                node_handle node = way.back().first;
+                size_t edge = way.back().second;
+                while (edge != invalid_handle && edge >= edges_count)
+                    edge = graph->edges[edge].next;
+                if (edge == invalid_handle) {
+                    way.pop_back();
+                    end_visitor(node);
+                    continue;
+                }
+                edge_t const& record = graph->edges[edge];
+                way.back().second = record.next;
+                node_handle next = record.to;
+                discover_visitor(next);
+                if (used[next])
+                    continue;
+                used[next] = true;
+                start_visitor(next);
+                way.push_back(std::make_pair(next, graph->nodes[next].head.load(std::memory_order_acquire)));
+            }
+        }
+
+    private:
+        friend class concurrent_graph_t;
+
+        snapshot_t(concurrent_graph_t const* graph, size_t nodes_count, size_t edges_count)
+            : graph(graph)
+            , nodes_count(nodes_count)
+            , edges_count(edges_count)
+        {}
+
+        concurrent_graph_t const* graph;
+        size_t nodes_count;
+        size_t edges_count;
+    };
+
+    /**
+    * Constructs empty graph
+    */
+    concurrent_graph_t()
+        : nodes_reserved(0)
+        , nodes_published(0)
+        , edges_reserved(0)
+        , edges_published(0)
+    {}
+
+    concurrent_graph_t(concurrent_graph_t const&) = delete;
+    concurrent_graph_t& operator=(concurrent_graph_t const&) = delete;
+
+    /**
+    * Creates new node and returns it's handle. Safe to call concurrently with any other method.
+    * @param value to put on the node
+    * @return handle to the newly created node
+    */
+    node_handle add_node(T const& value = T()) {
+        node_handle node = nodes_reserved.fetch_add(1, std::memory_order_relaxed);
+        node_t& record = nodes.ensure(node);
+        record.payload = value;
+        record.ready.store(true);
+        publish(nodes, nodes_published, nodes_reserved);
+        return node;
+    }
+
+    /**
+    * Adds new edge with given ends and returns it's handle. Safe to call concurrently with any other method.
+    * @param a start node handle
+    * @param b end node handle
+    * @param value to put on the edge
+    * @return handle to the newly created edge
+    * @throws std::runtime_error if any end isn't published yet
+    */
+    edge_handle add_edge(node_handle const& a, node_handle const& b, E const& value = E()) {
+        size_t published = nodes_published.load(std::memory_order_acquire);
+        if (a >= published || b >= published)
+            throw std::runtime_error("edge end doesn't exist");
+
+        edge_handle edge = edges_reserved.fetch_add(1, std::memory_order_relaxed);
+        edge_t& record = edges.ensure(edge);
+        record.from = a;
+        record.to = b;
+        record.payload = value;
+
+        std::atomic<size_t>& head = nodes[a].head;
+        size_t next = head.load(std::memory_order_relaxed);
+        do {
+            record.next = next;
+        } while (!head.compare_exchange_weak(next, edge, std::memory_order_release, std::memory_order_relaxed));
+
+        record.ready.store(true);
+        publish(edges, edges_published, edges_reserved);
+        return edge;
+    }
+
+    /**
+    * Takes consistent snapshot containing all completely added nodes and edges. Wait-free.
+    * @return snapshot of the graph
+    */
+    snapshot_t snapshot() const {
+        size_t edges_count = edges_published.load(std::memory_order_acquire);
+        size_t nodes_count = nodes_published.load(std::memory_order_acquire);
+        return snapshot_t(this, nodes_count, edges_count);
+    }
+
+private:
+    /**
+    * Advances published watermark over all ready records. Any appending thread may advance it past
+    * records of other threads, so no thread waits for another. Sequentially consistent operations
+    * guarantee that of two threads finishing adjacent records at least one sees the other's record ready.
+    */
+    template<typename Record>
+    static void publish(graph_detail::segmented_array<Record> const& records,
+                        std::atomic<size_t>& published, std::atomic<size_t> const& reserved) {
+        size_t current = published.load();
+        while (current < reserved.load()) {
+            Record* record = records.find(current);
+            if (record == nullptr || !record->ready.load())
+                break;
+            if (published.compare_exchange_weak(current, current + 1))
+                ++current;
+        }
+    }
+
+    graph_detail::segmented_array<node_t> nodes;
+    graph_detail::segmented_array<edge_t> edges;
+
+    std::atomic<size_t> nodes_reserved;
+    std::atomic<size_t> nodes_published;
+    std::atomic<size_t> edges_reserved;
+    std::atomic<size_t> edges_published;
+};
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <graph.h>
+
+/**
+* Which edges of each node are stored in csr_t
+*/
+enum edge_direction {
+    OUT_EDGES,
+    IN_EDGES
+};
+
+/**
+* Immutable compressed sparse row snapshot of graph_t adjacency.
+* Edges starting at each node are stored contiguously, so algorithms scanning
+* neighbours read sequential memory instead of per-node vectors.
+*/
+class csr_t {
+public:
+    typedef size_t node_handle;
+    typedef size_t edge_handle;
+
+    /**
+    * Constructs empty snapshot
+    */
+    csr_t() = default;
+
+    /**
+    * Builds snapshot of given graph's edges
+    * @param graph to take snapshot of, graph_t or any type providing
+    *        get_nodes_count(), for_each_edge(node, visitor) and get_target(edge)
+    * @param direction OUT_EDGES to store edges by their start nodes, IN_EDGES to store them by their end nodes
+    * @tparam Graph type of graph
+    */
+    template<typename Graph>
+    explicit csr_t(Graph const& graph, edge_direction direction = OUT_EDGES)
+        : offsets(graph.get_nodes_count() + 1, 0)
+    {
+        size_t n = graph.get_nodes_count();
+        bool incoming = direction == IN_EDGES;
+        for (node_handle node = 0; node < n; ++node) {
+            graph.for_each_edge(node, [this, &graph, node, incoming](edge_handle const& edge) {
+                ++offsets[(incoming ? graph.get_target(edge) : node) + 1];
+            });
+        }
+        for (node_handle node = 0; node < n; ++node)
+            offsets[node + 1] += offsets[node];
+
+        targets.resize(offsets[n]);
+        edges.resize(offsets[n]);
+        std::vector<size_t> position(offsets.begin(), offsets.end() - 1);
+        for (node_handle node = 0; node < n; ++node) {
+            graph.for_each_edge(node, [this, &graph, &position, node, incoming](edge_handle const& edge) {
+                node_handle other = graph.get_target(edge);
+                size_t& i = position[incoming ? other : node];
+                targets[i] = incoming ? node : other;
+                edges[i] = edge;
+                ++i;
+            });
+        }
+    }
+
+    /**
+    * Returns number of nodes in this snapshot
+    * @return number of nodes
+    */
+    size_t get_nodes_count() const {
+        return offsets.size() - 1;
+    }
+
+    /**
+    * Returns number of edges in this snapshot
+    * @return number of edges
+    */
+    size_t get_edges_count() const {
+        return targets.size();
+    }
+
+    /**
+    * Returns position of the first edge stored for given node
+    * @param node
+    * @return position of the first edge of given node
+    */
+    size_t begin(node_handle const& node) const {
+        return offsets[node];
+    }
+
+    /**
+    * Returns position past the last edge stored for given node
+    * @param node
+    * @return position past the last edge of given node
+    */
+    size_t end(node_handle const& node) const {
+        return offsets[node + 1];
+    }
+
+    /**
+    * Returns number of edges stored for given node
+    * @param node
+    * @return out degree or in degree of given node depending on snapshot direction
+    */
+    size_t get_degree(node_handle const& node) const {
+        return offsets[node + 1] - offsets[node];
+    }
+
+    /**
+    * Returns opposite node of the edge at given position:
+    * end node for OUT_EDGES snapshot, start node for IN_EDGES one
+    * @param position of edge in this snapshot
+    * @return opposite node of the edge
+    */
+    node_handle get_target(size_t position) const {
+        return targets[position];
+    }
+
+    /**
+    * Returns handle of the original graph edge at given position
+    * @param position of edge in this snapshot
+    * @return handle of the edge in the original graph
+    */
+    edge_handle get_edge(size_t position) const {
+        return edges[position];
+    }
+
+    /**
+    * Returns offsets of the node edge ranges, get_nodes_count() + 1 values
+    * @return offsets array
+    */
+    std::vector<size_t> const& get_offsets() const {
+        return offsets;
+    }
+
+    /**
+    * Copies edge values of given graph in the order of this snapshot
+    * @param graph this snapshot was built from
+    * @return edge values indexed by snapshot positions
+    */
+    template<typename T, typename E>
+    std::vector<E> arrange_payloads(graph_t<T, E> const& graph) const {
+        std::vector<E> result;
+        result.reserve(edges.size());
+        for (edge_handle edge : edges)
+            result.push_back(graph.edge_payload(edge));
+        return result;
+    }
+
+    /**
+    * Arranges given per-edge values, e.g. an edge attribute, in the order of this snapshot
+    * @param values indexed by original graph edge handles
+    * @tparam V type of values
+    * @return values indexed by snapshot positions
+    */
+    template<typename V>
+    std::vector<V> arrange(std::vector<V> const& values) const {
+        std::vector<V> result;
+        result.reserve(edges.size());
+        for (edge_handle edge : edges)
+            result.push_back(values[edge]);
+        return result;
+    }
+
+    /**
+    * Executes given visitor on each edge stored for the given node.
+    * @param source node
+    * @param visitor to execute with snapshot position and opposite node of each edge
+    * @tparam EdgeVisitor type of visitor
+    */
+    template<typename EdgeVisitor>
+    void for_each_edge(node_handle const& source, EdgeVisitor visitor) const {
+        for (size_t i = offsets[source]; i < offsets[source + 1]; ++i)
+            visitor(i, targets[i]);
+    }
+
+private:
+    std::vector<size_t> offsets = std::vector<size_t>(1, 0);
+    std::vector<node_handle> targets;
+    std::vector<edge_handle> edges;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include <graph.h>
+#include <graph/csr.h>
+#include <graph/undirected.h>
+
+/**
+* Computes core number of each node with edges treated as undirected, ignoring self loops and
+* parallel edges: the largest k such that the node belongs to a subgraph where all degrees are at least k.
+* Uses linear time bucket algorithm: nodes are kept sorted by current degree in one array
+* and peeled in increasing degree order, each degree decrement moves a node one bucket down in O(1).
+* @param csr snapshot of the graph
+* @return core number of each node
+* @see http://arxiv.org/abs/cs/0310049
+*/
+inline std::vector<size_t> core_numbers(csr_t const& csr) {
+    graph_detail::weighted_graph_t graph = graph_detail::symmetrize(csr);
+    size_t n = graph.size();
+    std::vector<size_t> degree(n);
+    size_t max_degree = 0;
+    for (size_t node = 0; node < n; ++node) {
+        degree[node] = graph.offsets[node + 1] - graph.offsets[node];
+        max_degree = std::max(max_degree, degree[node]);
+    }
+
+    std::vector<size_t> bucket_start(max_degree + 2, 0);
+    for (size_t node = 0; node < n; ++node)
+        ++bucket_start[degree[node] + 1];
+    for (size_t d = 0; d <= max_degree; ++d)
+        bucket_start[d + 1] += bucket_start[d];
+
+    std::vector<size_t> sorted(n);
+    std::vector<size_t> position(n);
+    std::vector<size_t> fill(bucket_start.begin(), bucket_start.end() - 1);
+    for (size_t node = 0; node < n; ++node) {
+        position[node] = fill[degree[node]]++;
+        sorted[position[node]] = node;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        size_t node = sorted[i];
+        for (size_t k = graph.offsets[node]; k < graph.offsets[node + 1]; ++k) {
+            size_t other = graph.targets[k];
+            if (degree[other] <= degree[node])
+                continue;
+            size_t d = degree[other];
+            size_t first = sorted[bucket_start[d]];
+            if (first != other) {
+                std::swap(sorted[position[other]], sorted[bucket_start[d]]);
+                std::swap(position[other], position[first]);
+            }
+            ++bucket_start[d];
+            --degree[other];
+        }
+    }
+    return degree;
+}
+
+/**
+* Returns nodes of k-core: maximal subgraph where each node has at least k neighbours
+* @param cores core number of each node, see core_numbers
+* @param k minimal degree
+* @return nodes of k-core in increasing order
+*/
+inline std::vector<size_t> k_core(std::vector<size_t> const& cores, size_t k) {
+    std::vector<size_t> result;
+    for (size_t node = 0; node < cores.size(); ++node) {
+        if (cores[node] >= k)
+            result.push_back(node);
+    }
+    return result;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include <graph.h>
+#include <graph/csr.h>
+#include <graph/vertex_program.h>
+
+/**
+* PageRank as a pull-based vertex program.
+* Rank of nodes without out-edges is spread uniformly over all nodes.
+* @see http://en.wikipedia.org/wiki/PageRank
+*/
+class pagerank_program {
+public:
+    typedef double value_type;
+    typedef double accumulator_type;
+
+    /**
+    * Constructs program for graph with given out degrees
+    * @param out_degrees number of out-edges of each node
+    * @param damping probability of following an edge
+    */
+    pagerank_program(std::vector<size_t> const& out_degrees, double damping)
+        : inverse_degrees(out_degrees.size())
+        , damping(damping)
+        , base(0)
+    {
+        for (size_t node = 0; node < out_degrees.size(); ++node)
+            inverse_degrees[node] = out_degrees[node] == 0 ? 0 : 1.0 / out_degrees[node];
+    }
+
+    void begin_iteration(std::vector<double> const& ranks) {
+        double dangling = 0;
+        for (size_t node = 0; node < ranks.size(); ++node) {
+            if (inverse_degrees[node] == 0)
+                dangling += ranks[node];
+        }
+        double n = static_cast<double>(ranks.size());
+        base = (1 - damping) / n + damping * dangling / n;
+    }
+
+    double zero(size_t) const {
+        return 0;
+    }
+
+    void gather(double& sum, size_t, size_t neighbour, size_t, double const& rank) const {
+        sum += rank * inverse_degrees[neighbour];
+    }
+
+    double apply(size_t, double const& sum, double const&) const {
+        return base + damping * sum;
+    }
+
+    double change(double const& rank, double const& updated) const {
+        return std::fabs(rank - updated);
+    }
+
+private:
+    std::vector<double> inverse_degrees;
+    double damping;
+    double base;
+};
+
+/**
+* Computes PageRank of each node of given graph.
+* @param graph to rank
+* @param damping probability of following an edge
+* @param tolerance iterations stop when sum of rank changes is less than tolerance
+* @param max_iterations maximal number of iterations to run
+* @param threads maximum number of threads to use
+* @return rank of each node, ranks sum up to 1
+*/
+template<typename T, typename E>
+std::vector<double> pagerank(graph_t<T, E> const& graph, double damping = 0.85, double tolerance = 1e-9,
+                             size_t max_iterations = 100, size_t threads = graph_detail::default_threads()) {
+    size_t n = graph.get_nodes_count();
+    if (n == 0)
+        return std::vector<double>();
+
+    std::vector<size_t> out_degrees(n);
+    for (size_t node = 0; node < n; ++node) {
+        graph.for_each_edge(node, [&out_degrees, node](size_t) {
+            ++out_degrees[node];
+        });
+    }
+
+    pagerank_program program(out_degrees, damping);
+    std::vector<double> ranks(n, 1.0 / n);
+    run_vertex_program(csr_t(graph, IN_EDGES), program, ranks, max_iterations, tolerance, threads);
+    return ranks;
+}
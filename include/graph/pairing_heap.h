@@ -0,0 +1,204 @@
+#pragma once
+
+#include <vector>
+#include <stdexcept>
+
+#include <graph.h>
+
+/**
+* Addressable min pairing heap over items 0..capacity-1 with decrease-key.
+* Tree links live in a flat array indexed by item and scratch space of pop and clear is reserved
+* for all items, so no allocations happen after construction or resize.
+* @tparam Key type of priorities
+*/
+template<typename Key>
+class pairing_heap {
+public:
+    /**
+    * Constructs heap for items in range [0, capacity)
+    * @param capacity number of items
+    */
+    explicit pairing_heap(size_t capacity = 0)
+        : items(capacity)
+        , root(invalid_handle)
+    {
+        pairs.reserve(capacity);
+    }
+
+    /**
+    * Changes number of items this heap can hold, clearing it
+    * @param capacity number of items
+    */
+    void resize(size_t capacity) {
+        clear();
+        items.resize(capacity);
+        pairs.reserve(capacity);
+    }
+
+    /**
+    * Checks if heap is empty
+    * @return true if heap contains no items, false otherwise
+    */
+    bool empty() const {
+        return root == invalid_handle;
+    }
+
+    /**
+    * Checks if given item is in the heap
+    * @param item to check
+    * @return true if item is in the heap, false otherwise
+    */
+    bool contains(size_t item) const {
+        return items[item].in_heap;
+    }
+
+    /**
+    * Returns item with minimal key
+    * @return item with minimal key
+    */
+    size_t top() const {
+        return root;
+    }
+
+    /**
+    * Returns key of the given item which is in the heap
+    * @param item
+    * @return key of the item
+    */
+    Key const& key(size_t item) const {
+        return items[item].key;
+    }
+
+    /**
+    * Inserts given item which isn't in the heap
+    * @param item to insert
+    * @param key of the item
+    */
+    void push(size_t item, Key const& key) {
+        item_t& node = items[item];
+        node.key = key;
+        node.child = node.sibling = node.prev = invalid_handle;
+        node.in_heap = true;
+        root = root == invalid_handle ? item : meld(root, item);
+    }
+
+    /**
+    * Decreases key of given item which is in the heap
+    * @param item to update
+    * @param key new key, must not be greater than current one
+    */
+    void decrease(size_t item, Key const& key) {
+        item_t& node = items[item];
+        node.key = key;
+        if (item == root)
+            return;
+        if (items[node.prev].child == item)
+            items[node.prev].child = node.sibling;
+        else
+            items[node.prev].sibling = node.sibling;
+        if (node.sibling != invalid_handle)
+            items[node.sibling].prev = node.prev;
+        node.sibling = node.prev = invalid_handle;
+        root = meld(root, item);
+    }
+
+    /**
+    * Inserts given item or decreases it's key if it's in the heap with greater key
+    * @param item to insert or update
+    * @param key of the item
+    * @return true if heap was changed, false otherwise
+    */
+    bool push_or_decrease(size_t item, Key const& key) {
+        if (!items[item].in_heap) {
+            push(item, key);
+            return true;
+        }
+        if (key < items[item].key) {
+            decrease(item, key);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+    * Removes item with minimal key and returns it
+    * @return removed item
+    * @throws std::runtime_error if heap is empty
+    */
+    size_t pop() {
+        if (root == invalid_handle)
+            throw std::runtime_error("pop from empty heap");
+        size_t result = root;
+        item_t& node = items[result];
+        node.in_heap = false;
+
+        pairs.clear();
+        for (size_t child = node.child; child != invalid_handle; ) {
+            size_t next = items[child].sibling;
+            items[child].sibling = items[child].prev = invalid_handle;
+            pairs.push_back(child);
+            child = next;
+        }
+        node.child = invalid_handle;
+
+        size_t count = 0;
+        for (size_t i = 0; i + 1 < pairs.size(); i += 2)
+            pairs[count++] = meld(pairs[i], pairs[i + 1]);
+        if (pairs.size() % 2 == 1)
+            pairs[count++] = pairs.back();
+
+        root = invalid_handle;
+        while (count > 0) {
+            size_t subtree = pairs[--count];
+            root = root == invalid_handle ? subtree : meld(subtree, root);
+        }
+        return result;
+    }
+
+    /**
+    * Removes all items from the heap in time proportional to the number of items in it
+    */
+    void clear() {
+        pairs.clear();
+        if (root != invalid_handle)
+            pairs.push_back(root);
+        while (!pairs.empty()) {
+            size_t item = pairs.back();
+            pairs.pop_back();
+            item_t& node = items[item];
+            if (node.child != invalid_handle)
+                pairs.push_back(node.child);
+            if (node.sibling != invalid_handle)
+                pairs.push_back(node.sibling);
+            node.in_heap = false;
+            node.child = node.sibling = node.prev = invalid_handle;
+        }
+        root = invalid_handle;
+    }
+
+private:
+    struct item_t {
+        Key key = Key();
+        size_t child = invalid_handle;
+        size_t sibling = invalid_handle;
+        size_t prev = invalid_handle;
+        bool in_heap = false;
+    };
+
+    size_t meld(size_t a, size_t b) {
+        if (items[b].key < items[a].key)
+            std::swap(a, b);
+        item_t& parent = items[a];
+        item_t& child = items[b];
+        child.sibling = parent.child;
+        if (parent.child != invalid_handle)
+            items[parent.child].prev = b;
+        child.prev = a;
+        parent.child = b;
+        return a;
+    }
+
+    std::vector<item_t> items;
+    std::vector<size_t> pairs;
+    size_t root;
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+
+namespace graph_detail {
+    /**
+    * Flag of a structure which is built lazily by const methods, with a mutex serializing the build.
+    * Readers check the flag without locking, builder sets it after the structure is complete.
+    * Copies take the flag value and get their own mutex.
+    */
+    class build_flag {
+    public:
+        build_flag(bool value = false)
+            : built(value)
+        {}
+
+        build_flag(build_flag const& other)
+            : built(other.get())
+        {}
+
+        build_flag& operator=(build_flag const& other) {
+            set(other.get());
+            return *this;
+        }
+
+        bool get() const {
+            return built.load(std::memory_order_acquire);
+        }
+
+        void set(bool value) {
+            built.store(value, std::memory_order_release);
+        }
+
+        std::mutex& mutex() {
+            return lock;
+        }
+    private:
+        std::atomic<bool> built;
+        std::mutex lock;
+    };
+
+    /**
+    * Returns number of threads to use when caller doesn't specify it
+    * @return number of hardware threads, at least 1
+    */
+    inline size_t default_threads() {
+        size_t threads = std::thread::hardware_concurrency();
+        return threads == 0 ? 1 : threads;
+    }
+
+    /**
+    * Splits range [begin, end) into at most given number of equal chunks and executes
+    * given body on each chunk in its own thread. The calling thread takes the first chunk.
+    * @param begin of the range
+    * @param end of the range
+    * @param threads maximum number of threads to use
+    * @param body to execute as body(chunk_index, chunk_begin, chunk_end)
+    * @tparam Body type of body
+    */
+    template<typename Body>
+    void parallel_for(size_t begin, size_t end, size_t threads, Body body) {
+        size_t size = end - begin;
+        if (threads > size)
+            threads = size;
+        if (threads <= 1) {
+            if (size > 0)
+                body(0, begin, end);
+            return;
+        }
+
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+        for (size_t i = 1; i < threads; ++i) {
+            size_t lo = begin + size * i / threads;
+            size_t hi = begin + size * (i + 1) / threads;
+            workers.push_back(std::thread([&body, i, lo, hi]() {
+                body(i, lo, hi);
+            }));
+        }
+        body(0, begin, begin + size / threads);
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    /**
+    * Splits nodes of compressed adjacency into contiguous ranges with roughly equal
+    * number of nodes plus edges in each, so threads get balanced work on skewed degree distributions.
+    * @param offsets of node edge ranges, nodes count + 1 values
+    * @param parts number of ranges
+    * @return parts + 1 range bounds
+    */
+    inline std::vector<size_t> partition_by_edges(std::vector<size_t> const& offsets, size_t parts) {
+        size_t n = offsets.size() - 1;
+        if (parts == 0)
+            parts = 1;
+        std::vector<size_t> bounds(parts + 1, n);
+        bounds[0] = 0;
+        size_t total = n + offsets[n];
+        size_t node = 0;
+        for (size_t part = 1; part < parts; ++part) {
+            size_t goal = total * part / parts;
+            while (node < n && node + offsets[node] < goal)
+                ++node;
+            bounds[part] = node;
+        }
+        return bounds;
+    }
+
+    /**
+    * Executes given body on each range defined by given bounds in it's own thread.
+    * The calling thread takes the first range.
+    * @param bounds of ranges, ranges count + 1 values
+    * @param body to execute as body(range_index, range_begin, range_end)
+    * @tparam Body type of body
+    */
+    template<typename Body>
+    void parallel_for_ranges(std::vector<size_t> const& bounds, Body body) {
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i + 1 < bounds.size(); ++i) {
+            size_t lo = bounds[i];
+            size_t hi = bounds[i + 1];
+            workers.push_back(std::thread([&body, i, lo, hi]() {
+                body(i, lo, hi);
+            }));
+        }
+        if (bounds.size() > 1)
+            body(0, bounds[0], bounds[1]);
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+}
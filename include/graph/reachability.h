@@ -0,0 +1,166 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+
+#include <graph.h>
+#include <graph/csr.h>
+#include <graph/components.h>
+
+/**
+* Transitive closure of a graph stored as one bitset row per node, so reachability queries are a single bit test.
+* Rows are built over the strongly connected components condensation in reverse topological order.
+* Memory is quadratic in the number of nodes, so the index is meant for graphs up to tens of thousands of nodes.
+*
+* The index is a snapshot and isn't attached to the graph it was built from. Caller keeps them in sync:
+* every graph_t::add_node and graph_t::add_edge must be followed by add_node and add_edge of the index
+* with the same handles, otherwise queries silently answer for the old graph. Removals aren't supported:
+* after remove_node, remove_edge, compact or permute build a new index, since closure rows can't be
+* shrunk in place and handles change on compaction.
+*/
+class reachability_index_t {
+public:
+    typedef size_t node_handle;
+
+    /**
+    * Constructs index of empty graph
+    */
+    reachability_index_t() = default;
+
+    /**
+    * Builds index of given snapshot
+    * @param csr snapshot of the graph
+    */
+    explicit reachability_index_t(csr_t const& csr) {
+        build(csr);
+    }
+
+    /**
+    * Builds index of given graph
+    * @param graph to index
+    * @tparam T type of values on nodes
+    * @tparam E type of values on edges
+    */
+    template<typename T, typename E>
+    explicit reachability_index_t(graph_t<T, E> const& graph) {
+        build(csr_t(graph));
+    }
+
+    /**
+    * Returns number of indexed nodes
+    * @return number of nodes
+    */
+    size_t get_nodes_count() const {
+        return nodes_count;
+    }
+
+    /**
+    * Checks if there is a path from source to target. Each node is reachable from itself.
+    * @param source start node
+    * @param target end node
+    * @return true if target is reachable from source, false otherwise
+    * @throws std::runtime_error if source or target isn't indexed
+    */
+    bool reachable(node_handle source, node_handle target) const {
+        check_node(source);
+        check_node(target);
+        return test(source, target);
+    }
+
+    /**
+    * Adds isolated node to the index, should be called together with graph_t::add_node
+    * @return handle of the new node
+    */
+    node_handle add_node() {
+        if (nodes_count == words_count * word_bits)
+            grow(std::max<size_t>(1, words_count * 2));
+        node_handle node = nodes_count++;
+        set(node, node);
+        return node;
+    }
+
+    /**
+    * Adds edge to the index, should be called together with graph_t::add_edge.
+    * Every node reaching a gets everything reachable from b, which costs O(n) bit tests
+    * plus one row union per such node, and nothing if b was already reachable from a.
+    * @param a start node
+    * @param b end node
+    * @throws std::runtime_error if a or b isn't indexed
+    */
+    void add_edge(node_handle a, node_handle b) {
+        check_node(a);
+        check_node(b);
+        if (test(a, b))
+            return;
+        uint64_t const* source = row(b);
+        for (node_handle node = 0; node < nodes_count; ++node) {
+            if (!test(node, a))
+                continue;
+            uint64_t* target = row(node);
+            for (size_t i = 0; i < words_count; ++i)
+                target[i] |= source[i];
+        }
+    }
+
+private:
+    static const size_t word_bits = 64;
+
+    void build(csr_t const& csr) {
+        nodes_count = csr.get_nodes_count();
+        words_count = (nodes_count + word_bits - 1) / word_bits;
+        bits.assign(words_count * word_bits * words_count, 0);
+
+        components_t components = strongly_connected_components(csr);
+        graph_t<std::vector<size_t>> dag = condensation(csr, components);
+        std::vector<uint64_t> closure(components.count * words_count, 0);
+        for (size_t component = components.count; component-- > 0; ) {
+            uint64_t* target = closure.data() + component * words_count;
+            for (size_t node : dag[component])
+                target[node / word_bits] |= uint64_t(1) << (node % word_bits);
+            dag.for_each_edge(component, [&](size_t edge) {
+                uint64_t const* source = closure.data() + dag.get_target(edge) * words_count;
+                for (size_t i = 0; i < words_count; ++i)
+                    target[i] |= source[i];
+            });
+        }
+        for (node_handle node = 0; node < nodes_count; ++node) {
+            uint64_t const* source = closure.data() + components.component[node] * words_count;
+            std::copy(source, source + words_count, row(node));
+        }
+    }
+
+    void grow(size_t words) {
+        std::vector<uint64_t> grown(words * words * word_bits, 0);
+        for (node_handle node = 0; node < nodes_count; ++node)
+            std::copy(row(node), row(node) + words_count, grown.begin() + node * words);
+        bits.swap(grown);
+        words_count = words;
+    }
+
+    void check_node(node_handle node) const {
+        if (node >= nodes_count)
+            throw std::runtime_error("node isn't indexed");
+    }
+
+    uint64_t* row(node_handle node) {
+        return bits.data() + node * words_count;
+    }
+
+    uint64_t const* row(node_handle node) const {
+        return bits.data() + node * words_count;
+    }
+
+    bool test(node_handle source, node_handle target) const {
+        return (row(source)[target / word_bits] >> (target % word_bits)) & 1;
+    }
+
+    void set(node_handle source, node_handle target) {
+        row(source)[target / word_bits] |= uint64_t(1) << (target % word_bits);
+    }
+
+    size_t nodes_count = 0;
+    size_t words_count = 0;
+    std::vector<uint64_t> bits;
+};
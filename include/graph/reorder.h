@@ -0,0 +1,320 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include <graph.h>
+#include <graph/csr.h>
+#include <graph/undirected.h>
+
+/**
+* Node orderings improving memory locality of traversals.
+* Each ordering is returned as a permutation: permutation[node] is the new handle of the node.
+* Pass it to graph_t::permute and use it to remap handles stored outside of the graph.
+*/
+
+namespace graph_detail {
+    /**
+    * Contracts heavy edge matching of given graph
+    * @param graph to coarsen
+    * @param mapping filled with coarse node of each node
+    * @return coarse graph
+    */
+    inline weighted_graph_t coarsen(weighted_graph_t const& graph, std::vector<size_t>& mapping) {
+        size_t n = graph.size();
+        std::vector<size_t> match(n, invalid_handle);
+        for (size_t node = 0; node < n; ++node) {
+            if (match[node] != invalid_handle)
+                continue;
+            size_t best = node;
+            size_t best_weight = 0;
+            for (size_t i = graph.offsets[node]; i < graph.offsets[node + 1]; ++i) {
+                size_t target = graph.targets[i];
+                if (match[target] == invalid_handle && graph.weights[i] > best_weight) {
+                    best = target;
+                    best_weight = graph.weights[i];
+                }
+            }
+            match[node] = best;
+            match[best] = node;
+        }
+
+        mapping.assign(n, invalid_handle);
+        std::vector<size_t> members;
+        members.reserve(n);
+        weighted_graph_t coarse;
+        for (size_t node = 0; node < n; ++node) {
+            if (mapping[node] != invalid_handle)
+                continue;
+            mapping[node] = mapping[match[node]] = coarse.node_weights.size();
+            members.push_back(node);
+            size_t weight = graph.node_weights[node];
+            if (match[node] != node)
+                weight += graph.node_weights[match[node]];
+            coarse.node_weights.push_back(weight);
+        }
+
+        size_t coarse_n = coarse.size();
+        coarse.offsets.assign(coarse_n + 1, 0);
+        for (size_t c = 0; c < coarse_n; ++c) {
+            size_t node = members[c];
+            for (size_t member = node; ; member = match[node]) {
+                for (size_t i = graph.offsets[member]; i < graph.offsets[member + 1]; ++i) {
+                    size_t target = mapping[graph.targets[i]];
+                    if (target != c) {
+                        coarse.targets.push_back(target);
+                        coarse.weights.push_back(graph.weights[i]);
+                    }
+                }
+                if (member == match[node])
+                    break;
+            }
+            coarse.offsets[c + 1] = coarse.targets.size();
+        }
+        merge_parallel_edges(coarse);
+        return coarse;
+    }
+
+    /**
+    * Splits nodes visited in breadth first order into parts of equal weight
+    */
+    inline std::vector<size_t> grow_partition(weighted_graph_t const& graph, size_t parts) {
+        size_t n = graph.size();
+        size_t total = 0;
+        for (size_t weight : graph.node_weights)
+            total += weight;
+
+        std::vector<size_t> part(n, invalid_handle);
+        std::vector<size_t> queue;
+        queue.reserve(n);
+        size_t accumulated = 0;
+        for (size_t root = 0; root < n; ++root) {
+            if (part[root] != invalid_handle)
+                continue;
+            size_t head = queue.size();
+            queue.push_back(root);
+            part[root] = 0;
+            while (head < queue.size()) {
+                size_t node = queue[head++];
+                part[node] = std::min(parts - 1, accumulated * parts / std::max<size_t>(total, 1));
+                accumulated += graph.node_weights[node];
+                for (size_t i = graph.offsets[node]; i < graph.offsets[node + 1]; ++i) {
+                    size_t target = graph.targets[i];
+                    if (part[target] == invalid_handle) {
+                        part[target] = 0;
+                        queue.push_back(target);
+                    }
+                }
+            }
+        }
+        return part;
+    }
+
+    /**
+    * Greedily moves nodes to the neighbouring part they are connected to most, keeping parts balanced
+    */
+    inline void refine_partition(weighted_graph_t const& graph, std::vector<size_t>& part, size_t parts,
+                                 double imbalance, size_t passes) {
+        size_t n = graph.size();
+        size_t total = 0;
+        std::vector<size_t> part_weights(parts, 0);
+        for (size_t node = 0; node < n; ++node) {
+            total += graph.node_weights[node];
+            part_weights[part[node]] += graph.node_weights[node];
+        }
+        size_t limit = static_cast<size_t>(total * (1 + imbalance) / parts) + 1;
+
+        std::vector<size_t> connection(parts, 0);
+        std::vector<size_t> touched;
+        for (size_t pass = 0; pass < passes; ++pass) {
+            bool moved = false;
+            for (size_t node = 0; node < n; ++node) {
+                size_t current = part[node];
+                for (size_t i = graph.offsets[node]; i < graph.offsets[node + 1]; ++i) {
+                    size_t target_part = part[graph.targets[i]];
+                    if (connection[target_part] == 0)
+                        touched.push_back(target_part);
+                    connection[target_part] += graph.weights[i];
+                }
+
+                size_t best = current;
+                size_t weight = graph.node_weights[node];
+                for (size_t candidate : touched) {
+                    if (candidate != current && connection[candidate] > connection[best]
+                            && part_weights[candidate] + weight <= limit)
+                        best = candidate;
+                }
+                if (best != current) {
+                    part[node] = best;
+                    part_weights[current] -= weight;
+                    part_weights[best] += weight;
+                    moved = true;
+                }
+
+                for (size_t candidate : touched)
+                    connection[candidate] = 0;
+                touched.clear();
+            }
+            if (!moved)
+                break;
+        }
+    }
+
+    inline std::vector<size_t> order_to_permutation(std::vector<size_t> const& order) {
+        std::vector<size_t> permutation(order.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            permutation[order[i]] = i;
+        return permutation;
+    }
+}
+
+/**
+* Orders nodes in breadth first order over out-edges, restarting from the least unvisited handle.
+* @param csr snapshot of the graph
+* @return new handle of each node
+*/
+inline std::vector<size_t> bfs_order(csr_t const& csr) {
+    size_t n = csr.get_nodes_count();
+    std::vector<size_t> order;
+    order.reserve(n);
+    std::vector<bool> used(n, false);
+    for (size_t root = 0; root < n; ++root) {
+        if (used[root])
+            continue;
+        size_t head = order.size();
+        order.push_back(root);
+        used[root] = true;
+        while (head < order.size()) {
+            size_t node = order[head++];
+            for (size_t i = csr.begin(node); i < csr.end(node); ++i) {
+                size_t next = csr.get_target(i);
+                if (!used[next]) {
+                    used[next] = true;
+                    order.push_back(next);
+                }
+            }
+        }
+    }
+    return graph_detail::order_to_permutation(order);
+}
+
+/**
+* Orders nodes by decreasing out degree, so hub nodes share cache lines.
+* Nodes with equal degree keep their relative order.
+* @param csr snapshot of the graph
+* @return new handle of each node
+*/
+inline std::vector<size_t> degree_order(csr_t const& csr) {
+    std::vector<size_t> order(csr.get_nodes_count());
+    for (size_t node = 0; node < order.size(); ++node)
+        order[node] = node;
+    std::stable_sort(order.begin(), order.end(), [&csr](size_t a, size_t b) {
+        return csr.get_degree(a) > csr.get_degree(b);
+    });
+    return graph_detail::order_to_permutation(order);
+}
+
+/**
+* Reverse Cuthill-McKee ordering of the graph with edges treated as undirected.
+* Reduces bandwidth of adjacency matrix, so neighbours get close handles.
+* @param csr snapshot of the graph
+* @return new handle of each node
+* @see http://en.wikipedia.org/wiki/Cuthill%E2%80%93McKee_algorithm
+*/
+inline std::vector<size_t> rcm_order(csr_t const& csr) {
+    graph_detail::weighted_graph_t graph = graph_detail::symmetrize(csr);
+    size_t n = graph.size();
+    auto degree = [&graph](size_t node) {
+        return graph.offsets[node + 1] - graph.offsets[node];
+    };
+
+    std::vector<size_t> roots(n);
+    for (size_t node = 0; node < n; ++node)
+        roots[node] = node;
+    std::stable_sort(roots.begin(), roots.end(), [&degree](size_t a, size_t b) {
+        return degree(a) < degree(b);
+    });
+
+    std::vector<size_t> order;
+    order.reserve(n);
+    std::vector<bool> used(n, false);
+    for (size_t root : roots) {
+        if (used[root])
+            continue;
+        size_t head = order.size();
+        order.push_back(root);
+        used[root] = true;
+        while (head < order.size()) {
+            size_t node = order[head++];
+            size_t first = order.size();
+            for (size_t i = graph.offsets[node]; i < graph.offsets[node + 1]; ++i) {
+                size_t next = graph.targets[i];
+                if (!used[next]) {
+                    used[next] = true;
+                    order.push_back(next);
+                }
+            }
+            std::stable_sort(order.begin() + first, order.end(), [&degree](size_t a, size_t b) {
+                return degree(a) < degree(b);
+            });
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return graph_detail::order_to_permutation(order);
+}
+
+/**
+* Multilevel partitioning of the graph with edges treated as undirected: graph is coarsened by
+* heavy edge matching, the coarsest one is split by breadth first growing, and the partition is
+* projected back with greedy boundary refinement on each level.
+* @param csr snapshot of the graph
+* @param parts number of parts
+* @param imbalance allowed excess of part size over the average one, as a share of average
+* @return part of each node in range [0, parts)
+* @throws std::runtime_error if parts is 0
+*/
+inline std::vector<size_t> multilevel_partition(csr_t const& csr, size_t parts, double imbalance = 0.03) {
+    if (parts == 0)
+        throw std::runtime_error("number of parts must be positive");
+
+    std::vector<graph_detail::weighted_graph_t> levels(1, graph_detail::symmetrize(csr));
+    std::vector<std::vector<size_t>> mappings;
+    size_t goal = std::max<size_t>(64, parts * 16);
+    while (levels.back().size() > goal) {
+        std::vector<size_t> mapping;
+        graph_detail::weighted_graph_t coarse = graph_detail::coarsen(levels.back(), mapping);
+        if (coarse.size() * 10 > levels.back().size() * 9)
+            break;
+        mappings.push_back(std::move(mapping));
+        levels.push_back(std::move(coarse));
+    }
+
+    std::vector<size_t> part = graph_detail::grow_partition(levels.back(), parts);
+    graph_detail::refine_partition(levels.back(), part, parts, imbalance, 8);
+    for (size_t level = mappings.size(); level > 0; --level) {
+        std::vector<size_t> const& mapping = mappings[level - 1];
+        std::vector<size_t> projected(mapping.size());
+        for (size_t node = 0; node < mapping.size(); ++node)
+            projected[node] = part[mapping[node]];
+        part.swap(projected);
+        graph_detail::refine_partition(levels[level - 1], part, parts, imbalance, 4);
+    }
+    return part;
+}
+
+/**
+* Orders nodes so that nodes of each part get consecutive handles.
+* Nodes of the same part keep their relative order.
+* @param part of each node, e.g. from multilevel_partition
+* @return new handle of each node
+*/
+inline std::vector<size_t> partition_order(std::vector<size_t> const& part) {
+    std::vector<size_t> order(part.size());
+    for (size_t node = 0; node < order.size(); ++node)
+        order[node] = node;
+    std::stable_sort(order.begin(), order.end(), [&part](size_t a, size_t b) {
+        return part[a] < part[b];
+    });
+    return graph_detail::order_to_permutation(order);
+}
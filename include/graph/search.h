@@ -0,0 +1,327 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+#include <graph.h>
+#include <graph/pairing_heap.h>
+
+/**
+* Result of point to point search
+* @tparam W type of path length
+*/
+template<typename W>
+struct path_t {
+    /**
+    * True if target is reachable from source
+    */
+    bool found = false;
+
+    /**
+    * Length of the path, meaningful only if path is found
+    */
+    W distance = W();
+
+    /**
+    * Edges of the path in order from source to target
+    */
+    std::vector<size_t> edges;
+};
+
+/**
+* Reusable state of point to point searches. Arrays are allocated once for the graph size
+* and each query resets only the nodes it touched, so a query which finishes early costs
+* time proportional to the explored part of the graph, not to the whole graph.
+* One workspace must not be used by several threads at the same time.
+* @tparam W type of distances
+*/
+template<typename W>
+class search_workspace {
+public:
+    /**
+    * Constructs workspace for graphs with given number of nodes
+    * @param n number of nodes
+    */
+    explicit search_workspace(size_t n = 0) {
+        resize(n);
+    }
+
+    /**
+    * Prepares workspace for a new query on graph with given number of nodes
+    * @param n number of nodes
+    */
+    void start(size_t n) {
+        if (n != stamp[0].size())
+            resize(n);
+        ++generation;
+        for (size_t side = 0; side < 2; ++side) {
+            heap[side].clear();
+            queue[side].clear();
+        }
+    }
+
+    /**
+    * Checks if given node is reached from given side in the current query
+    * @param side 0 for forward search, 1 for backward search
+    * @param node to check
+    * @return true if node is reached
+    */
+    bool reached(size_t side, size_t node) const {
+        return stamp[side][node] == generation;
+    }
+
+    /**
+    * Returns distance to given node from given side, unreachable() if it isn't reached
+    * @param side 0 for forward search, 1 for backward search
+    * @param node
+    * @return distance to the node
+    */
+    W get_distance(size_t side, size_t node) const {
+        return reached(side, node) ? distance[side][node] : unreachable();
+    }
+
+    /**
+    * Returns value of distance to nodes which aren't reached
+    * @return maximal value of W
+    */
+    static W unreachable() {
+        return std::numeric_limits<W>::max();
+    }
+
+    /**
+    * Marks node as reached from given side with given distance and last edge
+    * @param side 0 for forward search, 1 for backward search
+    * @param node reached node
+    * @param value distance to the node
+    * @param edge last edge of the path to the node
+    */
+    void reach(size_t side, size_t node, W const& value, size_t edge) {
+        stamp[side][node] = generation;
+        distance[side][node] = value;
+        parent[side][node] = edge;
+    }
+
+    /**
+    * Builds path through given meeting node from parents of both sides
+    * @param graph which was searched
+    * @param meeting node reached from both sides, or target reached from the forward side
+    * @param length of the path
+    * @return path from source to target
+    */
+    template<typename Graph>
+    path_t<W> make_path(Graph const& graph, size_t meeting, W const& length) const {
+        path_t<W> result;
+        result.found = true;
+        result.distance = length;
+        for (size_t node = meeting; parent[0][node] != invalid_handle; ) {
+            size_t edge = parent[0][node];
+            result.edges.push_back(edge);
+            node = graph.get_source(edge);
+        }
+        std::reverse(result.edges.begin(), result.edges.end());
+        if (reached(1, meeting)) {
+            for (size_t node = meeting; parent[1][node] != invalid_handle; ) {
+                size_t edge = parent[1][node];
+                result.edges.push_back(edge);
+                node = graph.get_target(edge);
+            }
+        }
+        return result;
+    }
+
+    /**
+    * Priority queues of forward and backward searches
+    */
+    pairing_heap<W> heap[2];
+
+    /**
+    * Frontiers of forward and backward breadth first searches
+    */
+    std::vector<size_t> queue[2];
+
+private:
+    void resize(size_t n) {
+        for (size_t side = 0; side < 2; ++side) {
+            heap[side].resize(n);
+            distance[side].assign(n, W());
+            parent[side].assign(n, invalid_handle);
+            stamp[side].assign(n, 0);
+        }
+        generation = 0;
+    }
+
+    std::vector<W> distance[2];
+    std::vector<size_t> parent[2];
+    std::vector<size_t> stamp[2];
+    size_t generation;
+};
+
+namespace graph_detail {
+    template<typename T, typename E>
+    void check_search_input(graph_t<T, E> const& graph, size_t source, size_t target) {
+        if (!graph.has_node(source) || !graph.has_node(target))
+            throw std::runtime_error("source or target node doesn't exist");
+    }
+
+    template<typename T, typename E, typename Visitor>
+    void for_each_side_edge(graph_t<T, E> const& graph, size_t side, size_t node, Visitor visitor) {
+        GRAPH_STATS_ADD(nodes_visited, 1);
+        if (side == 0) {
+            graph.for_each_edge(node, [&graph, &visitor](size_t edge) {
+                GRAPH_STATS_ADD(edges_scanned, 1);
+                visitor(edge, graph.get_target(edge));
+            });
+        } else {
+            graph.for_each_in_edge(node, [&graph, &visitor](size_t edge) {
+                GRAPH_STATS_ADD(edges_scanned, 1);
+                visitor(edge, graph.get_source(edge));
+            });
+        }
+    }
+}
+
+/**
+* Bidirectional breadth first search for the path with the least number of edges.
+* Expands whole level of the smaller frontier on each step using the in-edge index for backward steps.
+* @param graph to search in
+* @param source start node
+* @param target end node
+* @param workspace reusable state
+* @return shortest path, distance is the number of edges
+* @throws std::runtime_error if source or target doesn't exist
+*/
+template<typename T, typename E>
+path_t<size_t> bidirectional_bfs(graph_t<T, E> const& graph, size_t source, size_t target,
+                                 search_workspace<size_t>& workspace) {
+    graph_detail::check_search_input(graph, source, target);
+    workspace.start(graph.get_nodes_count());
+    workspace.reach(0, source, 0, invalid_handle);
+    workspace.reach(1, target, 0, invalid_handle);
+    if (source == target)
+        return workspace.make_path(graph, source, 0);
+
+    std::vector<size_t> next;
+    workspace.queue[0].push_back(source);
+    workspace.queue[1].push_back(target);
+    while (!workspace.queue[0].empty() && !workspace.queue[1].empty()) {
+        size_t side = workspace.queue[0].size() <= workspace.queue[1].size() ? 0 : 1;
+        size_t best = search_workspace<size_t>::unreachable();
+        size_t meeting = invalid_handle;
+        next.clear();
+        for (size_t node : workspace.queue[side]) {
+            size_t length = workspace.get_distance(side, node) + 1;
+            graph_detail::for_each_side_edge(graph, side, node, [&](size_t edge, size_t other) {
+                if (workspace.reached(side, other))
+                    return;
+                workspace.reach(side, other, length, edge);
+                next.push_back(other);
+                if (workspace.reached(1 - side, other) && length + workspace.get_distance(1 - side, other) < best) {
+                    best = length + workspace.get_distance(1 - side, other);
+                    meeting = other;
+                }
+            });
+        }
+        if (meeting != invalid_handle)
+            return workspace.make_path(graph, meeting, best);
+        GRAPH_STATS_MAX(max_frontier, next.size());
+        workspace.queue[side].swap(next);
+    }
+    return path_t<size_t>();
+}
+
+/**
+* Bidirectional Dijkstra's search using edge values as non-negative weights.
+* Runs forward search over out-edges and backward search over in-edges, always advancing the side
+* with the smaller tentative distance, and stops when sum of both tentative distances reaches the best path.
+* @param graph to search in
+* @param source start node
+* @param target end node
+* @param workspace reusable state
+* @return shortest path
+* @throws std::runtime_error if source or target doesn't exist
+*/
+template<typename T, typename W>
+path_t<W> bidirectional_dijkstra(graph_t<T, W> const& graph, size_t source, size_t target,
+                                 search_workspace<W>& workspace) {
+    graph_detail::check_search_input(graph, source, target);
+    workspace.start(graph.get_nodes_count());
+    workspace.reach(0, source, W(), invalid_handle);
+    workspace.reach(1, target, W(), invalid_handle);
+    workspace.heap[0].push(source, W());
+    workspace.heap[1].push(target, W());
+
+    W best = search_workspace<W>::unreachable();
+    size_t meeting = source == target ? source : invalid_handle;
+    if (meeting != invalid_handle)
+        best = W();
+
+    while (!workspace.heap[0].empty() && !workspace.heap[1].empty()) {
+        W top[2] = {workspace.heap[0].key(workspace.heap[0].top()), workspace.heap[1].key(workspace.heap[1].top())};
+        if (meeting != invalid_handle && !(top[0] + top[1] < best))
+            break;
+        size_t side = top[0] <= top[1] ? 0 : 1;
+        size_t node = workspace.heap[side].pop();
+        W base = workspace.get_distance(side, node);
+        graph_detail::for_each_side_edge(graph, side, node, [&](size_t edge, size_t other) {
+            W candidate = base + graph.edge_payload(edge);
+            if (candidate < workspace.get_distance(side, other)) {
+                workspace.reach(side, other, candidate, edge);
+                workspace.heap[side].push_or_decrease(other, candidate);
+            }
+            if (workspace.reached(1 - side, other)) {
+                W total = workspace.get_distance(side, other) + workspace.get_distance(1 - side, other);
+                if (total < best) {
+                    best = total;
+                    meeting = other;
+                }
+            }
+        });
+    }
+
+    if (meeting == invalid_handle)
+        return path_t<W>();
+    return workspace.make_path(graph, meeting, best);
+}
+
+/**
+* A* search using edge values as non-negative weights.
+* Heuristic is inlined like the visitors of graph_t::dfs; it must never overestimate the distance
+* to target. With consistent heuristic each node is expanded at most once.
+* @param graph to search in
+* @param source start node
+* @param target end node
+* @param heuristic lower bound of distance from given node to target, called as heuristic(node)
+* @param workspace reusable state
+* @tparam Heuristic type of heuristic
+* @return shortest path
+* @throws std::runtime_error if source or target doesn't exist
+* @see http://en.wikipedia.org/wiki/A*_search_algorithm
+*/
+template<typename T, typename W, typename Heuristic>
+path_t<W> astar(graph_t<T, W> const& graph, size_t source, size_t target, Heuristic heuristic,
+                search_workspace<W>& workspace) {
+    graph_detail::check_search_input(graph, source, target);
+    workspace.start(graph.get_nodes_count());
+    workspace.reach(0, source, W(), invalid_handle);
+    workspace.heap[0].push(source, heuristic(source));
+
+    while (!workspace.heap[0].empty()) {
+        size_t node = workspace.heap[0].pop();
+        W base = workspace.get_distance(0, node);
+        if (node == target)
+            return workspace.make_path(graph, target, base);
+        GRAPH_STATS_ADD(nodes_visited, 1);
+        graph.for_each_edge(node, [&](size_t edge) {
+            GRAPH_STATS_ADD(edges_scanned, 1);
+            size_t next = graph.get_target(edge);
+            W candidate = base + graph.edge_payload(edge);
+            if (candidate < workspace.get_distance(0, next)) {
+                workspace.reach(0, next, candidate, edge);
+                workspace.heap[0].push_or_decrease(next, candidate + heuristic(next));
+            }
+        });
+    }
+    return path_t<W>();
+}
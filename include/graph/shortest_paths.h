@@ -0,0 +1,261 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+#include <graph.h>
+#include <graph/csr.h>
+#include <graph/parallel.h>
+#include <graph/pairing_heap.h>
+
+/**
+* Result of single source shortest paths search
+* @tparam W type of edge weights
+*/
+template<typename W>
+struct shortest_paths_t {
+    /**
+    * Distance from source to each node, unreachable() for nodes which can't be reached
+    */
+    std::vector<W> distance;
+
+    /**
+    * Last edge of the shortest path to each node, invalid_handle for source and unreachable nodes
+    */
+    std::vector<size_t> parent;
+
+    /**
+    * Constructs result for given number of nodes with all nodes unreachable
+    * @param n number of nodes
+    */
+    explicit shortest_paths_t(size_t n = 0)
+        : distance(n, unreachable())
+        , parent(n, invalid_handle)
+    {}
+
+    /**
+    * Returns distance value of unreachable nodes
+    * @return maximal value of W
+    */
+    static W unreachable() {
+        return std::numeric_limits<W>::max();
+    }
+};
+
+namespace graph_detail {
+    template<typename W>
+    void check_shortest_paths_input(csr_t const& csr, std::vector<W> const& weights, size_t source) {
+        if (source >= csr.get_nodes_count())
+            throw std::runtime_error("source node doesn't exist");
+        if (weights.size() != csr.get_edges_count())
+            throw std::runtime_error("weights count doesn't match edges count");
+        for (W const& weight : weights) {
+            if (weight < W())
+                throw std::runtime_error("negative edge weight");
+        }
+    }
+
+    /**
+    * Adds non-negative weight to a distance, saturating at shortest_paths_t<W>::unreachable()
+    * so integer distances don't wrap around
+    */
+    template<typename W>
+    W extend_distance(W base, W weight) {
+        W limit = shortest_paths_t<W>::unreachable();
+        return weight > limit - base ? limit : base + weight;
+    }
+}
+
+/**
+* Dijkstra's single source shortest paths over csr snapshot using pairing heap.
+* Distances which don't fit into W are reported as unreachable.
+* @param csr snapshot of the graph
+* @param weights non-negative edge weights in the order of snapshot positions
+* @param source node to start from
+* @tparam W type of edge weights
+* @return distances and shortest paths tree
+* @throws std::runtime_error if source doesn't exist or any weight is negative
+* @see http://en.wikipedia.org/wiki/Dijkstra%27s_algorithm
+*/
+template<typename W>
+shortest_paths_t<W> dijkstra(csr_t const& csr, std::vector<W> const& weights, size_t source) {
+    graph_detail::check_shortest_paths_input(csr, weights, source);
+
+    shortest_paths_t<W> result(csr.get_nodes_count());
+    std::vector<W>& distance = result.distance;
+    pairing_heap<W> heap(csr.get_nodes_count());
+
+    distance[source] = W();
+    heap.push(source, W());
+    while (!heap.empty()) {
+        size_t node = heap.pop();
+        W base = distance[node];
+        GRAPH_STATS_ADD(nodes_visited, 1);
+        GRAPH_STATS_ADD(edges_scanned, csr.end(node) - csr.begin(node));
+        for (size_t i = csr.begin(node); i < csr.end(node); ++i) {
+            size_t next = csr.get_target(i);
+            W candidate = graph_detail::extend_distance(base, weights[i]);
+            if (candidate < distance[next]) {
+                distance[next] = candidate;
+                result.parent[next] = csr.get_edge(i);
+                heap.push_or_decrease(next, candidate);
+            }
+        }
+    }
+    return result;
+}
+
+/**
+* Dijkstra's single source shortest paths using edge values as weights.
+* @param graph to search in
+* @param source node to start from
+* @tparam T type of values on nodes
+* @tparam W type of values on edges, used as weights
+* @return distances and shortest paths tree
+* @throws std::runtime_error if source doesn't exist or any weight is negative
+*/
+template<typename T, typename W>
+shortest_paths_t<W> dijkstra(graph_t<T, W> const& graph, size_t source) {
+    csr_t csr(graph);
+    return dijkstra(csr, csr.arrange_payloads(graph), source);
+}
+
+/**
+* Parallel delta-stepping single source shortest paths over csr snapshot.
+* Nodes are kept in buckets of width delta; each bucket is settled by rounds of light edge
+* (weight <= delta) relaxations followed by one round of heavy edge relaxations.
+* Relaxation requests of a round are generated by threads in parallel and applied sequentially.
+* Buckets are reused cyclically, only max weight / delta + 2 of them are allocated.
+* Distances which don't fit into W are reported as unreachable.
+* @param csr snapshot of the graph
+* @param weights non-negative edge weights in the order of snapshot positions
+* @param source node to start from
+* @param delta width of the bucket, must be positive
+* @param threads maximum number of threads to use
+* @tparam W type of edge weights
+* @return distances and shortest paths tree
+* @throws std::runtime_error if source doesn't exist, any weight is negative, delta isn't positive
+*         or max weight / delta exceeds 2^24
+* @see http://en.wikipedia.org/wiki/Parallel_single-source_shortest_path_algorithm#Delta_stepping_algorithm
+*/
+template<typename W>
+shortest_paths_t<W> delta_stepping(csr_t const& csr, std::vector<W> const& weights, size_t source, W delta,
+                                   size_t threads = graph_detail::default_threads()) {
+    graph_detail::check_shortest_paths_input(csr, weights, source);
+    if (!(W() < delta))
+        throw std::runtime_error("delta must be positive");
+    static const size_t max_buckets = size_t(1) << 24;
+    W max_weight = W();
+    for (W const& weight : weights)
+        max_weight = std::max(max_weight, weight);
+    if (static_cast<double>(max_weight) / static_cast<double>(delta) >= max_buckets)
+        throw std::runtime_error("delta is too small for the largest weight");
+
+    struct request_t {
+        size_t node;
+        W distance;
+        size_t edge;
+    };
+
+    static const size_t min_chunk = 1024;
+    size_t n = csr.get_nodes_count();
+    shortest_paths_t<W> result(n);
+    std::vector<W>& distance = result.distance;
+    std::vector<std::vector<size_t>> buckets(static_cast<size_t>(max_weight / delta) + 2);
+    size_t pending = 1;
+    std::vector<std::vector<request_t>> requests(threads == 0 ? 1 : threads);
+    std::vector<size_t> frontier;
+    std::vector<size_t> settled;
+    std::vector<size_t> round_mark(n, invalid_handle);
+    std::vector<size_t> settled_mark(n, invalid_handle);
+    size_t round = 0;
+
+    distance[source] = W();
+    buckets[0].push_back(source);
+
+    auto generate = [&](std::vector<size_t> const& origins, bool light) {
+        size_t workers = std::min(requests.size(), origins.size() / min_chunk + 1);
+        graph_detail::parallel_for(0, origins.size(), workers, [&](size_t thread, size_t lo, size_t hi) {
+            std::vector<request_t>& out = requests[thread];
+            for (size_t k = lo; k < hi; ++k) {
+                size_t node = origins[k];
+                W base = distance[node];
+                for (size_t i = csr.begin(node); i < csr.end(node); ++i) {
+                    if ((weights[i] <= delta) == light) {
+                        request_t request = {csr.get_target(i), graph_detail::extend_distance(base, weights[i]), csr.get_edge(i)};
+                        out.push_back(request);
+                    }
+                }
+            }
+        });
+    };
+
+    auto relax = [&]() {
+        for (std::vector<request_t>& out : requests) {
+            GRAPH_STATS_ADD(edges_scanned, out.size());
+            for (request_t const& request : out) {
+                if (request.distance < distance[request.node]) {
+                    distance[request.node] = request.distance;
+                    result.parent[request.node] = request.edge;
+                    size_t bucket = static_cast<size_t>(request.distance / delta);
+                    buckets[bucket % buckets.size()].push_back(request.node);
+                    ++pending;
+                }
+            }
+            out.clear();
+        }
+    };
+
+    for (size_t current = 0; pending != 0; ++current) {
+        std::vector<size_t>& bucket = buckets[current % buckets.size()];
+        settled.clear();
+        while (!bucket.empty()) {
+            frontier.clear();
+            frontier.swap(bucket);
+            pending -= frontier.size();
+            size_t count = 0;
+            for (size_t node : frontier) {
+                if (static_cast<size_t>(distance[node] / delta) != current || round_mark[node] == round)
+                    continue;
+                round_mark[node] = round;
+                frontier[count++] = node;
+                if (settled_mark[node] != current) {
+                    settled_mark[node] = current;
+                    settled.push_back(node);
+                }
+            }
+            frontier.resize(count);
+            ++round;
+            GRAPH_STATS_ADD(nodes_visited, count);
+            GRAPH_STATS_MAX(max_frontier, count);
+
+            generate(frontier, true);
+            relax();
+        }
+        if (settled.empty())
+            continue;
+        generate(settled, false);
+        relax();
+    }
+    return result;
+}
+
+/**
+* Parallel delta-stepping single source shortest paths using edge values as weights.
+* @param graph to search in
+* @param source node to start from
+* @param delta width of the bucket, must be positive
+* @param threads maximum number of threads to use
+* @tparam T type of values on nodes
+* @tparam W type of values on edges, used as weights
+* @return distances and shortest paths tree
+* @throws std::runtime_error if source doesn't exist, any weight is negative or delta isn't positive
+*/
+template<typename T, typename W>
+shortest_paths_t<W> delta_stepping(graph_t<T, W> const& graph, size_t source, W delta,
+                                   size_t threads = graph_detail::default_threads()) {
+    csr_t csr(graph);
+    return delta_stepping(csr, csr.arrange_payloads(graph), source, delta, threads);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+/**
+* Counters of work done by traversal algorithms on the current thread.
+* Counting is compiled in only when GRAPH_STATS is defined, otherwise all counters stay zero
+* and instrumentation points compile to nothing.
+*/
+struct traversal_stats {
+    /**
+    * Number of nodes entered by traversals
+    */
+    size_t nodes_visited = 0;
+
+    /**
+    * Number of edges scanned by traversals
+    */
+    size_t edges_scanned = 0;
+
+    /**
+    * Maximal size of stack, queue or frontier of traversals
+    */
+    size_t max_frontier = 0;
+
+    /**
+    * Number of allocations and reallocations of traversal state
+    */
+    size_t allocations = 0;
+};
+
+namespace graph_detail {
+    inline traversal_stats& thread_stats() {
+        static thread_local traversal_stats stats;
+        return stats;
+    }
+
+    /**
+    * Appends value to given vector counting reallocation if GRAPH_STATS is defined
+    */
+    template<typename Vector, typename Value>
+    void tracked_push(Vector& vector, Value&& value) {
+#ifdef GRAPH_STATS
+        size_t capacity = vector.capacity();
+        vector.push_back(std::forward<Value>(value));
+        if (vector.capacity() != capacity)
+            ++thread_stats().allocations;
+#else
+        vector.push_back(std::forward<Value>(value));
+#endif
+    }
+}
+
+#ifdef GRAPH_STATS
+#define GRAPH_STATS_ADD(field, value) (graph_detail::thread_stats().field += (value))
+#define GRAPH_STATS_MAX(field, value) (graph_detail::thread_stats().field = \
+        std::max<size_t>(graph_detail::thread_stats().field, (value)))
+#else
+#define GRAPH_STATS_ADD(field, value) ((void) 0)
+#define GRAPH_STATS_MAX(field, value) ((void) 0)
+#endif
+
+/**
+* Returns traversal counters of the current thread
+* @return counters accumulated since the last reset
+*/
+inline traversal_stats get_traversal_stats() {
+    return graph_detail::thread_stats();
+}
+
+/**
+* Resets traversal counters of the current thread
+*/
+inline void reset_traversal_stats() {
+    graph_detail::thread_stats() = traversal_stats();
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <stdint.h>
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <graph.h>
+#include <graph/csr.h>
+#include <graph/parallel.h>
+#include <graph/undirected.h>
+
+/**
+* Triangles of the graph with edges treated as undirected, ignoring self loops and parallel edges
+*/
+struct triangles_t {
+    /**
+    * Total number of triangles
+    */
+    size_t total = 0;
+
+    /**
+    * Number of triangles each node belongs to
+    */
+    std::vector<size_t> per_node;
+};
+
+namespace graph_detail {
+    /**
+    * Executes given visitor on each common element of two sorted arrays of unique values, in increasing order.
+    * With SSE2 compares blocks of four values of both arrays against each other in all four rotations
+    * and visits matched lanes of the first block.
+    * @return number of common elements
+    * @tparam CommonVisitor type of visitor
+    */
+    template<typename CommonVisitor>
+    size_t for_each_common(uint32_t const* a, size_t a_size, uint32_t const* b, size_t b_size, CommonVisitor visitor) {
+        size_t i = 0;
+        size_t j = 0;
+        size_t count = 0;
+#ifdef __SSE2__
+        while (i + 4 <= a_size && j + 4 <= b_size) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + j));
+            __m128i equal = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+                             _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+                _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                             _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+            for (int mask = _mm_movemask_ps(_mm_castsi128_ps(equal)); mask != 0; mask &= mask - 1) {
+                visitor(a[i + __builtin_ctz(mask)]);
+                ++count;
+            }
+            uint32_t a_last = a[i + 3];
+            uint32_t b_last = b[j + 3];
+            if (a_last <= b_last)
+                i += 4;
+            if (b_last <= a_last)
+                j += 4;
+        }
+#endif
+        while (i < a_size && j < b_size) {
+            uint32_t x = a[i];
+            uint32_t y = b[j];
+            if (x == y) {
+                visitor(x);
+                ++count;
+            }
+            i += x <= y;
+            j += y <= x;
+        }
+        return count;
+    }
+}
+
+/**
+* Counts triangles by intersecting sorted adjacency lists. Nodes are ranked by degree and each
+* undirected edge is kept only in the list of it's lower ranked end, so every triangle is found
+* exactly once and lists of high degree nodes stay short. Nodes are split between threads by
+* number of edges.
+* @param csr snapshot of the graph
+* @param threads maximum number of threads to use
+* @return total number of triangles and number of triangles of each node
+* @throws std::runtime_error if graph has 2^32 nodes or more
+*/
+inline triangles_t count_triangles(csr_t const& csr, size_t threads = graph_detail::default_threads()) {
+    graph_detail::weighted_graph_t graph = graph_detail::symmetrize(csr);
+    size_t n = graph.size();
+    if (n >= (static_cast<size_t>(1) << 32))
+        throw std::runtime_error("too many nodes for triangle counting");
+
+    std::vector<size_t> order(n);
+    for (size_t node = 0; node < n; ++node)
+        order[node] = node;
+    std::stable_sort(order.begin(), order.end(), [&graph](size_t a, size_t b) {
+        return graph.offsets[a + 1] - graph.offsets[a] < graph.offsets[b + 1] - graph.offsets[b];
+    });
+    std::vector<uint32_t> rank(n);
+    for (size_t i = 0; i < n; ++i)
+        rank[order[i]] = static_cast<uint32_t>(i);
+
+    std::vector<size_t> offsets(n + 1, 0);
+    for (size_t node = 0; node < n; ++node) {
+        for (size_t i = graph.offsets[node]; i < graph.offsets[node + 1]; ++i) {
+            if (rank[node] < rank[graph.targets[i]])
+                ++offsets[rank[node] + 1];
+        }
+    }
+    for (size_t r = 0; r < n; ++r)
+        offsets[r + 1] += offsets[r];
+    std::vector<uint32_t> forward(offsets[n]);
+    std::vector<size_t> position(offsets.begin(), offsets.end() - 1);
+    for (size_t node = 0; node < n; ++node) {
+        for (size_t i = graph.offsets[node]; i < graph.offsets[node + 1]; ++i) {
+            if (rank[node] < rank[graph.targets[i]])
+                forward[position[rank[node]]++] = rank[graph.targets[i]];
+        }
+    }
+    for (size_t r = 0; r < n; ++r)
+        std::sort(forward.begin() + offsets[r], forward.begin() + offsets[r + 1]);
+
+    std::vector<std::atomic<size_t>> counts(n);
+    for (std::atomic<size_t>& count : counts)
+        count.store(0, std::memory_order_relaxed);
+    std::vector<size_t> bounds = graph_detail::partition_by_edges(offsets, std::max<size_t>(1, threads));
+    std::vector<size_t> totals(bounds.size() - 1, 0);
+    graph_detail::parallel_for_ranges(bounds, [&](size_t part, size_t lo, size_t hi) {
+        size_t total = 0;
+        for (size_t a = lo; a < hi; ++a) {
+            uint32_t const* a_list = forward.data() + offsets[a];
+            size_t a_size = offsets[a + 1] - offsets[a];
+            size_t a_count = 0;
+            for (size_t k = 0; k < a_size; ++k) {
+                uint32_t b = a_list[k];
+                uint32_t const* b_list = forward.data() + offsets[b];
+                size_t b_size = offsets[b + 1] - offsets[b];
+                size_t common = graph_detail::for_each_common(a_list + k + 1, a_size - k - 1, b_list, b_size,
+                    [&counts](uint32_t c) {
+                        counts[c].fetch_add(1, std::memory_order_relaxed);
+                    });
+                if (common == 0)
+                    continue;
+                a_count += common;
+                counts[b].fetch_add(common, std::memory_order_relaxed);
+            }
+            counts[a].fetch_add(a_count, std::memory_order_relaxed);
+            total += a_count;
+        }
+        totals[part] = total;
+    });
+
+    triangles_t result;
+    for (size_t total : totals)
+        result.total += total;
+    result.per_node.resize(n);
+    for (size_t node = 0; node < n; ++node)
+        result.per_node[node] = counts[rank[node]].load(std::memory_order_relaxed);
+    return result;
+}
+
+/**
+* Computes local clustering coefficient of each node: share of pairs of it's neighbours which are connected,
+* with edges treated as undirected.
+* @param csr snapshot of the graph
+* @param threads maximum number of threads to use
+* @return clustering coefficient of each node, 0 for nodes with less than two neighbours
+*/
+inline std::vector<double> clustering_coefficients(csr_t const& csr, size_t threads = graph_detail::default_threads()) {
+    triangles_t triangles = count_triangles(csr, threads);
+    graph_detail::weighted_graph_t graph = graph_detail::symmetrize(csr);
+    std::vector<double> result(graph.size(), 0);
+    for (size_t node = 0; node < graph.size(); ++node) {
+        double degree = static_cast<double>(graph.offsets[node + 1] - graph.offsets[node]);
+        if (degree >= 2)
+            result[node] = 2.0 * triangles.per_node[node] / (degree * (degree - 1));
+    }
+    return result;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+
+#include <graph.h>
+#include <graph/csr.h>
+
+namespace graph_detail {
+    /**
+    * Undirected graph with weights on nodes and edges in compressed form
+    */
+    struct weighted_graph_t {
+        std::vector<size_t> offsets;
+        std::vector<size_t> targets;
+        std::vector<size_t> weights;
+        std::vector<size_t> node_weights;
+
+        size_t size() const {
+            return node_weights.size();
+        }
+    };
+
+    /**
+    * Merges parallel edges of each node of given raw adjacency summing their weights
+    */
+    inline void merge_parallel_edges(weighted_graph_t& graph) {
+        size_t n = graph.size();
+        std::vector<size_t> slot(n, invalid_handle);
+        size_t count = 0;
+        size_t begin = 0;
+        for (size_t node = 0; node < n; ++node) {
+            size_t end = graph.offsets[node + 1];
+            size_t first = count;
+            for (size_t i = begin; i < end; ++i) {
+                size_t target = graph.targets[i];
+                if (slot[target] != invalid_handle && slot[target] >= first) {
+                    graph.weights[slot[target]] += graph.weights[i];
+                } else {
+                    slot[target] = count;
+                    graph.targets[count] = target;
+                    graph.weights[count] = graph.weights[i];
+                    ++count;
+                }
+            }
+            begin = end;
+            graph.offsets[node + 1] = count;
+        }
+        graph.targets.resize(count);
+        graph.weights.resize(count);
+    }
+
+    /**
+    * Builds undirected unit-weight view of given snapshot without self loops
+    */
+    inline weighted_graph_t symmetrize(csr_t const& csr) {
+        size_t n = csr.get_nodes_count();
+        weighted_graph_t result;
+        result.node_weights.assign(n, 1);
+        result.offsets.assign(n + 1, 0);
+        for (size_t node = 0; node < n; ++node) {
+            for (size_t i = csr.begin(node); i < csr.end(node); ++i) {
+                size_t target = csr.get_target(i);
+                if (target != node) {
+                    ++result.offsets[node + 1];
+                    ++result.offsets[target + 1];
+                }
+            }
+        }
+        for (size_t node = 0; node < n; ++node)
+            result.offsets[node + 1] += result.offsets[node];
+
+        result.targets.resize(result.offsets[n]);
+        result.weights.assign(result.offsets[n], 1);
+        std::vector<size_t> position(result.offsets.begin(), result.offsets.end() - 1);
+        for (size_t node = 0; node < n; ++node) {
+            for (size_t i = csr.begin(node); i < csr.end(node); ++i) {
+                size_t target = csr.get_target(i);
+                if (target != node) {
+                    result.targets[position[node]++] = target;
+                    result.targets[position[target]++] = node;
+                }
+            }
+        }
+        merge_parallel_edges(result);
+        return result;
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <stdexcept>
+
+#include <graph/csr.h>
+#include <graph/parallel.h>
+
+/**
+* Runs pull-based bulk synchronous vertex program over in-edges of a graph.
+* On each iteration every node gathers values of it's in-neighbours from the previous iteration
+* into an accumulator and applies it to get it's new value. Nodes are split between threads
+* by number of in-edges, and iterations stop when total change of values drops below tolerance.
+*
+* Program must provide:
+*   typedef ... value_type;
+*   typedef ... accumulator_type;
+*   void begin_iteration(std::vector<value_type> const& values);
+*   accumulator_type zero(size_t node) const;
+*   void gather(accumulator_type& accumulator, size_t node, size_t neighbour, size_t edge,
+*               value_type const& neighbour_value) const;
+*   value_type apply(size_t node, accumulator_type const& accumulator, value_type const& value) const;
+*   double change(value_type const& value, value_type const& updated) const;
+*
+* @param in_edges IN_EDGES snapshot of the graph
+* @param program to run
+* @param values initial value of each node, replaced with the final ones
+* @param max_iterations maximal number of iterations to run
+* @param tolerance iterations stop when sum of changes is less than tolerance
+* @param threads maximum number of threads to use
+* @tparam Program type of program
+* @return number of executed iterations
+* @throws std::runtime_error if values count doesn't match nodes count
+*/
+template<typename Program>
+size_t run_vertex_program(csr_t const& in_edges, Program& program, std::vector<typename Program::value_type>& values,
+                          size_t max_iterations, double tolerance, size_t threads = graph_detail::default_threads()) {
+    typedef typename Program::value_type value_type;
+    typedef typename Program::accumulator_type accumulator_type;
+
+    size_t n = in_edges.get_nodes_count();
+    if (values.size() != n)
+        throw std::runtime_error("values count doesn't match nodes count");
+
+    static const size_t min_part = 4096;
+    size_t parts = std::max<size_t>(1, std::min(threads, (n + in_edges.get_edges_count()) / min_part));
+    std::vector<size_t> bounds = graph_detail::partition_by_edges(in_edges.get_offsets(), parts);
+    std::vector<double> changes(parts);
+    std::vector<value_type> updated(values);
+
+    size_t iteration = 0;
+    while (iteration < max_iterations) {
+        program.begin_iteration(values);
+        Program const& step = program;
+        graph_detail::parallel_for_ranges(bounds, [&](size_t part, size_t lo, size_t hi) {
+            double change = 0;
+            for (size_t node = lo; node < hi; ++node) {
+                accumulator_type accumulator = step.zero(node);
+                for (size_t i = in_edges.begin(node); i < in_edges.end(node); ++i) {
+                    size_t neighbour = in_edges.get_target(i);
+                    step.gather(accumulator, node, neighbour, in_edges.get_edge(i), values[neighbour]);
+                }
+                updated[node] = step.apply(node, accumulator, values[node]);
+                change += step.change(values[node], updated[node]);
+            }
+            changes[part] = change;
+        });
+        values.swap(updated);
+        ++iteration;
+
+        double total = 0;
+        for (double change : changes)
+            total += change;
+        if (total < tolerance)
+            break;
+    }
+    return iteration;
+}
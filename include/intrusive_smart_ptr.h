@@ -0,0 +1,228 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+/**
+* Reference counting pointer wrapper for types which keep the reference counter inside.
+* Counter is manipulated through smart_ptr_add_ref(T*) and smart_ptr_release(T*) functions found by
+* argument dependent lookup, intrusive_ref_counter provides them for derived types.
+* Wrapper is one pointer wide and needs no control block. Different instances may be used from
+* different threads, but unlike smart_ptr one instance must not be assigned while it's copied.
+* @tparam T type of underlying value
+*/
+template<typename T>
+class intrusive_smart_ptr {
+public:
+    /**
+    * Constructs wrapper with given pointer increasing it's reference counter
+    * @param ptr pointer to wrap
+    */
+	intrusive_smart_ptr(T * ptr = nullptr)
+		: ptr(ptr)
+	{
+		if (ptr != nullptr)
+			smart_ptr_add_ref(ptr);
+	}
+
+    /**
+    * Copies given intrusive_smart_ptr increasing underlying reference counter if it's value isn't nullptr
+    * @param orig value to copy
+    */
+	intrusive_smart_ptr(intrusive_smart_ptr const& orig)
+		: intrusive_smart_ptr(orig.ptr)
+	{}
+
+    /**
+    * Moves pointer from given intrusive_smart_ptr to newly constructed one. Reference counter isn't increased.
+    * @param orig value to move
+    */
+	intrusive_smart_ptr(intrusive_smart_ptr && orig)
+		: ptr(orig.ptr)
+	{
+		orig.ptr = nullptr;
+	}
+
+    /**
+    * Destroys this wrapper decreasing reference counter
+    */
+	~intrusive_smart_ptr() {
+		if (ptr != nullptr)
+			smart_ptr_release(ptr);
+	}
+
+    /**
+    * Returns underlying pointer
+    * @return underlying pointer
+    */
+	T* get() const {
+		return ptr;
+	}
+
+    /**
+    * Dereferences the underlying pointer
+    * @return reference to the underlying value
+    */
+	T & operator*() const {
+		return *ptr;
+	}
+
+    /**
+    * Returns underlying pointer
+    * @return underlying pointer
+    */
+	T * operator->() const {
+		return ptr;
+	}
+
+    /**
+    * Checks if underlying pointer of this intrusive_smart_ptr is less then underlying pointer of given one
+    * @param other intrusive_smart_ptr to compare with
+    * @return true if this->get() < other.get(), false otherwise
+    */
+	bool operator<(intrusive_smart_ptr const& other) const {
+		return ptr < other.ptr;
+	}
+
+    /**
+    * Checks if underlying pointer of this intrusive_smart_ptr is greater then underlying pointer of given one
+    * @param other intrusive_smart_ptr to compare with
+    * @return true if this->get() > other.get(), false otherwise
+    */
+	bool operator>(intrusive_smart_ptr const& other) const {
+		return other < (*this);
+	}
+
+    /**
+    * Checks if underlying pointer of this intrusive_smart_ptr is less then or equal to underlying pointer of given one
+    * @param other intrusive_smart_ptr to compare with
+    * @return true if this->get() <= other.get(), false otherwise
+    */
+	bool operator<=(intrusive_smart_ptr const& other) const {
+		return !(other < (*this));
+	}
+
+    /**
+    * Checks if underlying pointer of this intrusive_smart_ptr is greater then or equal to underlying pointer of given one
+    * @param other intrusive_smart_ptr to compare with
+    * @return true if this->get() >= other.get(), false otherwise
+    */
+	bool operator>=(intrusive_smart_ptr const& other) const {
+		return !((*this) < other);
+	}
+
+    /**
+    * Checks if underlying pointer of this intrusive_smart_ptr is equal to underlying pointer of given one
+    * @param other intrusive_smart_ptr to compare with
+    * @return true if this->get() == other.get(), false otherwise
+    */
+	bool operator==(intrusive_smart_ptr const& other) const {
+		return ptr == other.ptr;
+	}
+
+    /**
+    * Checks if underlying pointer of this intrusive_smart_ptr is not equal to underlying pointer of given one
+    * @param other intrusive_smart_ptr to compare with
+    * @return true if this->get() != other.get(), false otherwise
+    */
+	bool operator!=(intrusive_smart_ptr const& other) const {
+		return ptr != other.ptr;
+	}
+
+    /**
+    * Checks if underlying pointer doesn't point to null
+    * @return true if this->get() != nullptr, false otherwise
+    */
+	operator bool() const {
+		return ptr != nullptr;
+	}
+
+    /**
+    * Cast to int is prohibited
+    */
+	operator int() const = delete;
+    /**
+    * Cast to void* is prohibited
+    */
+	operator void*() const = delete;
+
+    /**
+    * Assign given intrusive_smart_ptr to this performing all necessary reference counter manipulations.
+    * @param other value to assign
+    * @return this
+    */
+	intrusive_smart_ptr& operator=(intrusive_smart_ptr other) {
+		std::swap(ptr, other.ptr);
+		return *this;
+	}
+
+    /**
+    * Assigns new pointer to this intrusive_smart_ptr, decreasing reference counter of the old one.
+    * @param new_value pointer to assign
+    */
+	void reset(T * new_value = nullptr) {
+		intrusive_smart_ptr(new_value).swap(*this);
+	}
+
+    /**
+    * Exchanges pointers of this and given intrusive_smart_ptr
+    * @param other value to swap with
+    */
+	void swap(intrusive_smart_ptr& other) {
+		std::swap(ptr, other.ptr);
+	}
+private:
+	T* ptr;
+};
+
+/**
+* Base class embedding atomic reference counter into derived type for use with intrusive_smart_ptr.
+* Counter isn't copied together with the value. Value is deleted through Derived*, so no virtual destructor is needed.
+* @tparam Derived type deriving from this class
+*/
+template<typename Derived>
+class intrusive_ref_counter {
+public:
+	intrusive_ref_counter()
+		: references(0)
+	{}
+
+	intrusive_ref_counter(intrusive_ref_counter const&)
+		: references(0)
+	{}
+
+	intrusive_ref_counter& operator=(intrusive_ref_counter const&) {
+		return *this;
+	}
+
+    /**
+    * Returns current number of references, useful only for diagnostics in multithreaded code
+    * @return number of references
+    */
+	int use_count() const {
+		return references.load(std::memory_order_relaxed);
+	}
+
+	friend void smart_ptr_add_ref(intrusive_ref_counter const* value) {
+		value->references.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	friend void smart_ptr_release(intrusive_ref_counter const* value) {
+		if (value->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			delete static_cast<Derived const*>(value);
+	}
+protected:
+	~intrusive_ref_counter() = default;
+private:
+	mutable std::atomic_int references;
+};
+
+/**
+* Creates intrusive_smart_ptr with pointer obtained by calling given type's constructor with given arguments.
+* @tparam T type of underlying value
+* @tparam Args arguments types
+*/
+template<typename T, typename... Args>
+intrusive_smart_ptr<T> make_intrusive(Args&&... args) {
+	return intrusive_smart_ptr<T>(new T(std::forward<Args>(args)...));
+}
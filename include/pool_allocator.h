@@ -0,0 +1,223 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <new>
+
+#include <smart_ptr.h>
+
+namespace smart_ptr_detail {
+    /**
+    * Pool of equally sized items owned by one thread. Owner allocates and frees through a plain free list,
+    * other threads return items through a lock-free remote list which the owner takes over when
+    * it runs out of free items. Pool is destroyed when it's owner has exited and all items are returned.
+    * Items requested by destructors of thread_local objects which run after the owner thread has released
+    * it's pool are taken from operator new and carry no owner.
+    * @tparam Size size of items without header, multiple of 16
+    */
+	template<size_t Size>
+	class size_class_pool {
+	public:
+        /**
+        * Header preceding each item, it keeps items aligned to 16 bytes
+        */
+		struct alignas(16) item_header {
+			size_class_pool* owner;
+			item_header* next;
+		};
+
+        /**
+        * Returns pool of the current thread, creating it on the first call
+        * @return pool of the current thread or nullptr if the thread is exiting and has already released it's pool
+        */
+		static size_class_pool* local() {
+			struct ownership {
+				size_class_pool* pool;
+
+				ownership()
+					: pool(new size_class_pool())
+				{
+					current() = pool;
+				}
+
+				~ownership() {
+					current() = nullptr;
+					released() = true;
+					pool->release();
+				}
+			};
+			if (released())
+				return nullptr;
+			static thread_local ownership owned;
+			return owned.pool;
+		}
+
+        /**
+        * Allocates item which belongs to no pool, deallocate returns it to operator delete
+        */
+		static void* allocate_unowned() {
+			item_header* item = static_cast<item_header*>(::operator new(item_size));
+			item->owner = nullptr;
+			item->next = nullptr;
+			return item + 1;
+		}
+
+		void* allocate() {
+			if (free_items == nullptr)
+				free_items = remote_items.exchange(nullptr, std::memory_order_acquire);
+			if (free_items == nullptr)
+				grow();
+			item_header* item = free_items;
+			free_items = item->next;
+			references.fetch_add(1, std::memory_order_relaxed);
+			return item + 1;
+		}
+
+        /**
+        * Returns item to it's owner pool, may be called by any thread
+        */
+		static void deallocate(void* ptr) {
+			item_header* item = static_cast<item_header*>(ptr) - 1;
+			size_class_pool* owner = item->owner;
+			if (owner == nullptr) {
+				::operator delete(item);
+				return;
+			}
+			if (owner == current()) {
+				item->next = owner->free_items;
+				owner->free_items = item;
+			} else {
+				item_header* head = owner->remote_items.load(std::memory_order_relaxed);
+				do {
+					item->next = head;
+				} while (!owner->remote_items.compare_exchange_weak(head, item,
+						std::memory_order_release, std::memory_order_relaxed));
+			}
+			owner->release();
+		}
+	private:
+        /**
+        * Pool of the current thread or nullptr if it has none, doesn't create one
+        */
+		static size_class_pool*& current() {
+			static thread_local size_class_pool* pool = nullptr;
+			return pool;
+		}
+
+        /**
+        * Whether the current thread has released it's pool on exit, trivially destructible so it stays
+        * readable from destructors of other thread_local objects
+        */
+		static bool& released() {
+			static thread_local bool value = false;
+			return value;
+		}
+
+		static const size_t item_size = sizeof(item_header) + Size;
+		static const size_t chunk_items = 16384 / item_size < 16 ? 16 : 16384 / item_size;
+
+		size_class_pool()
+			: free_items(nullptr)
+			, remote_items(nullptr)
+			, references(1)
+		{}
+
+		~size_class_pool() {
+			for (char* chunk : chunks)
+				::operator delete(chunk);
+		}
+
+		void grow() {
+			char* chunk = static_cast<char*>(::operator new(chunk_items * item_size));
+			chunks.push_back(chunk);
+			for (size_t i = chunk_items; i-- > 0; ) {
+				item_header* item = reinterpret_cast<item_header*>(chunk + i * item_size);
+				item->owner = this;
+				item->next = free_items;
+				free_items = item;
+			}
+		}
+
+        /**
+        * Drops reference of an item or of the owner thread, destroying the pool after the last one
+        */
+		void release() {
+			if (references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				delete this;
+		}
+
+		item_header* free_items;
+		std::atomic<item_header*> remote_items;
+		std::atomic<size_t> references;
+		std::vector<char*> chunks;
+	};
+}
+
+/**
+* Allocator taking single objects up to 256 bytes from per-thread size class pools, so allocation
+* and same-thread deallocation don't touch the global heap. Objects freed by other threads are returned
+* to their owner pool without locks. Arrays and bigger or over-aligned objects use operator new.
+* Allocation and deallocation stay valid during thread exit, after the thread's pool is released
+* objects are allocated from operator new. All instances are interchangeable.
+* @tparam T type of allocated objects
+*/
+template<typename T>
+class pool_allocator {
+public:
+	typedef T value_type;
+
+	pool_allocator() = default;
+
+	template<typename U>
+	pool_allocator(pool_allocator<U> const&)
+	{}
+
+    /**
+    * Allocates memory for given number of objects
+    * @param n number of objects
+    * @return pointer to uninitialized memory
+    */
+	T* allocate(size_t n) {
+		if (n != 1 || !pooled)
+			return static_cast<T*>(::operator new(n * sizeof(T)));
+		pool_t* pool = pool_t::local();
+		return static_cast<T*>(pool != nullptr ? pool->allocate() : pool_t::allocate_unowned());
+	}
+
+    /**
+    * Frees memory allocated by any pool_allocator
+    * @param ptr memory to free
+    * @param n number of objects
+    */
+	void deallocate(T* ptr, size_t n) {
+		if (n != 1 || !pooled)
+			::operator delete(ptr);
+		else
+			pool_t::deallocate(ptr);
+	}
+
+	bool operator==(pool_allocator const&) const {
+		return true;
+	}
+
+	bool operator!=(pool_allocator const&) const {
+		return false;
+	}
+private:
+	static const size_t size_class = (sizeof(T) + 15) / 16 * 16;
+	static const bool pooled = size_class <= 256 && alignof(T) <= 16;
+
+	typedef smart_ptr_detail::size_class_pool<size_class> pool_t;
+};
+
+/**
+* Creates smart_ptr with value and control block allocated together from the current thread's pool
+* @tparam T type of underlying value
+* @tparam Policy reference counting policy
+* @tparam Args arguments types
+*/
+template<typename T, typename Policy = atomic_counting, typename... Args>
+smart_ptr<T, Policy> make_pooled(Args&&... args) {
+	return allocate_smart<T, Policy>(pool_allocator<T>(), std::forward<Args>(args)...);
+}
@@ -3,51 +3,364 @@
 #include <iostream>
 #include <atomic>
 #include <thread>
+#include <cstdint>
+#include <type_traits>
+#include <memory>
+#include <new>
 #include <mutex>
+#include <chrono>
+#include <condition_variable>
+
+#include <smart_ptr_stats.h>
+
+namespace smart_ptr_detail {
+#if UINTPTR_MAX == UINT64_MAX
+    /**
+    * State of a smart_ptr instance: control block address in the low 48 bits and number of copies
+    * in flight in the top 16 bits. Relies on user space addresses fitting into 48 bits, as on x86-64
+    * and AArch64 with 4-level page tables.
+    */
+	typedef uintptr_t state_word;
+#else
+    /**
+    * On 32-bit targets the state is a double word with the address in the low half.
+    * It's lock-free where the CPU has a double word compare-and-swap (cmpxchg8b, ldrexd/strexd),
+    * otherwise std::atomic falls back to a lock.
+    */
+	typedef uint64_t state_word;
+#endif
+
+    /**
+    * Base of control blocks which are never reclaimed on retirement
+    */
+	struct no_hook {};
+
+    /**
+    * Base of control blocks which can be linked into a retire list
+    */
+	struct retire_hook {
+		retire_hook* next_retired = nullptr;
+
+        /**
+        * Destroys the retired value and drops it's control block reference
+        */
+		virtual void reclaim() = 0;
+	protected:
+		~retire_hook() = default;
+	};
+
+    /**
+    * Treiber stack of retired blocks owned by one thread at a time. Owner pushes, any thread
+    * takes the whole stack at once, so there is no ABA problem.
+    */
+	struct retire_list {
+		std::atomic<retire_hook*> head;
+		std::atomic_bool owned;
+		retire_list* next_list;
+
+		retire_list()
+			: head(nullptr)
+			, owned(true)
+			, next_list(nullptr)
+		{}
+	};
+
+    /**
+    * Global registry of retire lists. Lists are never freed: when a thread exits it's list
+    * is released and adopted by the next thread which needs one.
+    */
+	inline std::atomic<retire_list*>& retire_lists() {
+		static std::atomic<retire_list*> lists(nullptr);
+		return lists;
+	}
+
+	inline retire_list* adopt_retire_list() {
+		std::atomic<retire_list*>& lists = retire_lists();
+		for (retire_list* list = lists.load(std::memory_order_acquire); list != nullptr; list = list->next_list) {
+			bool owned = false;
+			if (!list->owned.load(std::memory_order_relaxed)
+					&& list->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+				return list;
+		}
+		retire_list* list = new retire_list();
+		retire_list* head = lists.load(std::memory_order_relaxed);
+		do {
+			list->next_list = head;
+		} while (!lists.compare_exchange_weak(head, list, std::memory_order_release, std::memory_order_relaxed));
+		return list;
+	}
+
+	struct retire_list_owner {
+		retire_list* list = nullptr;
+
+		~retire_list_owner() {
+			if (list != nullptr)
+				list->owned.store(false, std::memory_order_release);
+		}
+	};
+
+	inline void retire(retire_hook* hook) {
+		static thread_local retire_list_owner owner;
+		if (owner.list == nullptr)
+			owner.list = adopt_retire_list();
+		retire_hook* head = owner.list->head.load(std::memory_order_relaxed);
+		do {
+			hook->next_retired = head;
+		} while (!owner.list->head.compare_exchange_weak(head, hook, std::memory_order_release, std::memory_order_relaxed));
+	}
+}
+
+/**
+* Destroys values retired by smart_ptr with deferred_counting policy on all threads.
+* May be called by any thread at any time, e.g. at a quiescent point of the application.
+* Values retired while reclaiming, e.g. members of destroyed values, are reclaimed too.
+* @return number of destroyed values
+*/
+inline size_t reclaim_retired() {
+	size_t reclaimed = 0;
+	for (bool found = true; found; ) {
+		found = false;
+		smart_ptr_detail::retire_list* list = smart_ptr_detail::retire_lists().load(std::memory_order_acquire);
+		for (; list != nullptr; list = list->next_list) {
+			smart_ptr_detail::retire_hook* hook = list->head.exchange(nullptr, std::memory_order_acquire);
+			while (hook != nullptr) {
+				smart_ptr_detail::retire_hook* next = hook->next_retired;
+				hook->reclaim();
+				hook = next;
+				++reclaimed;
+				found = true;
+			}
+		}
+	}
+	return reclaimed;
+}
+
+/**
+* Background thread calling reclaim_retired() periodically, and once more when it's stopped.
+*/
+class background_reclaimer {
+public:
+    /**
+    * Starts reclaiming thread
+    * @param period between reclamations
+    */
+	explicit background_reclaimer(std::chrono::milliseconds period = std::chrono::milliseconds(10))
+		: period(period)
+		, stopped(false)
+		, thread([this]() {
+			run();
+		})
+	{}
+
+	background_reclaimer(background_reclaimer const&) = delete;
+	background_reclaimer& operator=(background_reclaimer const&) = delete;
+
+    /**
+    * Stops reclaiming thread after the final reclamation
+    */
+	~background_reclaimer() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopped = true;
+		}
+		wakeup.notify_one();
+		thread.join();
+	}
+private:
+	void run() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (!stopped) {
+			wakeup.wait_for(lock, period);
+			lock.unlock();
+			reclaim_retired();
+			lock.lock();
+		}
+	}
+
+	std::chrono::milliseconds period;
+	bool stopped;
+	std::mutex mutex;
+	std::condition_variable wakeup;
+	std::thread thread;
+};
+
+/**
+* Reference counting policy for values shared between threads: increments are relaxed,
+* decrements are acquire-release so the value is destroyed after all writes to it.
+*/
+struct atomic_counting {
+	typedef std::atomic_int counter_type;
+
+    /**
+    * Whether smart_ptr instances may be copied and assigned concurrently
+    */
+	static const bool concurrent = true;
+
+    /**
+    * Whether values are retired to be destroyed by reclaim_retired() instead of destroyed in place
+    */
+	static const bool deferred = false;
+
+	typedef smart_ptr_detail::no_hook hook_type;
+
+	static int load(counter_type const& counter) {
+		return counter.load(std::memory_order_acquire);
+	}
+
+	static void increment(counter_type& counter, int count = 1) {
+		counter.fetch_add(count, std::memory_order_relaxed);
+	}
+
+    /**
+    * Adds given delta to the counter
+    * @return new value of the counter
+    */
+	static int add(counter_type& counter, int delta) {
+		return counter.fetch_add(delta, std::memory_order_acq_rel) + delta;
+	}
+
+	static bool increment_if_not_zero(counter_type& counter) {
+		int count = counter.load(std::memory_order_relaxed);
+		while (count != 0) {
+			if (counter.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel))
+				return true;
+		}
+		return false;
+	}
+};
+
+/**
+* Reference counting policy for values used by a single thread at a time, counters are plain ints.
+* Instances of smart_ptr with this policy must not be copied or assigned concurrently.
+*/
+struct plain_counting {
+	typedef int counter_type;
+
+	static const bool concurrent = false;
+	static const bool deferred = false;
+
+	typedef smart_ptr_detail::no_hook hook_type;
+
+	static int load(counter_type const& counter) {
+		return counter;
+	}
+
+	static void increment(counter_type& counter, int count = 1) {
+		counter += count;
+	}
+
+	static int add(counter_type& counter, int delta) {
+		return counter += delta;
+	}
+
+	static bool increment_if_not_zero(counter_type& counter) {
+		if (counter == 0)
+			return false;
+		++counter;
+		return true;
+	}
+};
+
+/**
+* Atomic reference counting policy which takes destruction off the thread dropping the last reference:
+* the value is pushed to this thread's lock-free retire list and destroyed by reclaim_retired(),
+* called explicitly or by background_reclaimer. Expired weak references see the value as destroyed at once.
+*/
+struct deferred_counting : atomic_counting {
+	static const bool deferred = true;
+
+	typedef smart_ptr_detail::retire_hook hook_type;
+};
+
+template<typename T, typename Policy>
+class smart_ptr;
+
+template<typename T, typename Policy>
+class weak_smart_ptr;
+
+template<typename T>
+class atomic_smart_ptr;
+
+template<typename T, typename Policy = atomic_counting, typename Alloc, typename... Args>
+smart_ptr<T, Policy> allocate_smart(Alloc const& alloc, Args&&... args);
 
 /**
 * Thread-safe reference counting pointer wrapper.
 * Destroys underlying value when reference count equals 0.
+* Instance is a single atomic word holding the control block address and, in the top 16 bits,
+* the number of copies of this instance in flight (split reference count). So dereference is a plain load
+* and the same instance can be copied and assigned concurrently without locks.
+* On 64-bit targets addresses must fit into 48 bits and up to 65535 copies of one instance may be in flight.
+* On 32-bit targets the word is 64 bits wide, see smart_ptr_detail::state_word.
+* Values created by make_smart live inside their control block, so they cost one allocation
+* and their address is computed from the control block address without loading it.
+* Control block also counts weak references and holds type-erased deleter and allocator.
 * @tparam T type of underlying value
+* @tparam Policy reference counting policy, atomic_counting or plain_counting
 */
-template<typename T>
+template<typename T, typename Policy = atomic_counting>
 class smart_ptr {
+	template<typename U, typename P, typename Alloc, typename... Args>
+	friend smart_ptr<U, P> allocate_smart(Alloc const& alloc, Args&&... args);
+	friend class weak_smart_ptr<T, Policy>;
+	friend class atomic_smart_ptr<T>;
 public:
     /**
-    * Constructs wrapper with given pointer
+    * Constructs wrapper with given pointer, which will be deleted with delete
     * @param ptr pointer to wrap
     */
 	smart_ptr(T * ptr = nullptr)
-		: value(ptr == nullptr ? nullptr : new value_container(ptr))
+		: state(adopt(ptr, std::default_delete<T>(), std::allocator<T>()))
+	{}
+
+    /**
+    * Constructs wrapper with given pointer, which will be destroyed by calling deleter(ptr)
+    * @param ptr pointer to wrap
+    * @param deleter to call instead of delete, e.g. to return the value to a pool
+    * @tparam D type of deleter
+    * @throws anything the control block allocation throws, given pointer is passed to deleter in that case
+    */
+	template<typename D>
+	smart_ptr(T * ptr, D deleter)
+		: state(adopt(ptr, deleter, std::allocator<T>()))
+	{}
+
+    /**
+    * Constructs wrapper with given pointer, which will be destroyed by calling deleter(ptr),
+    * allocating the control block with given allocator
+    * @param ptr pointer to wrap
+    * @param deleter to call instead of delete
+    * @param alloc allocator for the control block
+    * @tparam D type of deleter
+    * @tparam Alloc type of allocator
+    * @throws anything the control block allocation throws, given pointer is passed to deleter in that case
+    */
+	template<typename D, typename Alloc>
+	smart_ptr(T * ptr, D deleter, Alloc const& alloc)
+		: state(adopt(ptr, deleter, alloc))
 	{}
 
     /**
     * Copies given smart_ptr increasing underlying reference counter if it's value isn't nullptr
     * @param orig value to copy
     */
-	smart_ptr(smart_ptr const& orig) {
-		std::lock_guard<std::mutex> lock(orig.mutex);
-		value = orig.value;
-		if (value != nullptr) {
-			value->counter++;
-		}
-	}
+	smart_ptr(smart_ptr const& orig)
+		: state(orig.acquire())
+	{}
 
     /**
     * Moves pointer from given smart_ptr to newly constructed smart_ptr. Reference counter isn't increased.
     * @param org value to move
     */
 	smart_ptr(smart_ptr && orig)
-		: value(orig.value)
-	{
-		orig.value = nullptr;
-	}
+		: state(settle(orig.exchange(0)))
+	{}
 
     /**
     * Destroys this wrapper decreasing reference counter and destroying underlying value if needed
     */
 	~smart_ptr() {
-		reset(nullptr);
+		release(exchange(0));
 	}
 
     /**
@@ -55,8 +368,8 @@ public:
     * @return underlying pointer
     */
 	T* get() const {
-		std::lock_guard<std::mutex> lock(mutex);
-		return value == nullptr ? nullptr : value->ptr;
+		SMART_PTR_STATS_ADD(T, dereferences, 1);
+		return pointer(state.load(std::memory_order_acquire));
 	}
 
     /**
@@ -81,7 +394,7 @@ public:
     * @return true if this->get() < ptr.get(), false otherwise
     */
 	bool operator<(smart_ptr const& ptr) const {
-		return get() < ptr.get();
+		return pointer(state.load(std::memory_order_acquire)) < pointer(ptr.state.load(std::memory_order_acquire));
 	}
 
     /**
@@ -117,7 +430,7 @@ public:
     * @return true if this->get() == ptr.get(), false otherwise
     */
 	bool operator==(smart_ptr const& ptr) const {
-		return get() == ptr.get();
+		return pointer(state.load(std::memory_order_acquire)) == pointer(ptr.state.load(std::memory_order_acquire));
 	}
 
     /**
@@ -134,7 +447,7 @@ public:
     * @return true if this->get() != nullptr, false otherwise
     */
 	operator bool() const {
-		return value != nullptr;
+		return block(state.load(std::memory_order_acquire)) != nullptr;
 	}
 
     /**
@@ -152,8 +465,8 @@ public:
     * @return this
     */
 	smart_ptr& operator=(smart_ptr ptr) {
-		std::lock_guard<std::mutex> lock(mutex);
-		std::swap(value, ptr.value);
+		SMART_PTR_STATS_ADD(T, resets, 1);
+		ptr.state.store(exchange(ptr.state.load(std::memory_order_relaxed)), std::memory_order_relaxed);
 		return *this;
 	}
 
@@ -162,35 +475,512 @@ public:
     * @param new_value pointer to assign
     */
 	void reset(T * new_value = nullptr) {
-		std::lock_guard<std::mutex> lock(mutex);
-		value_container* old = value;
-		value = new_value == nullptr ? nullptr : new value_container(new_value);
-		if (old != nullptr && --old->counter == 0) {
-			delete old->ptr;
-			delete old;
-		}
+		SMART_PTR_STATS_ADD(T, resets, 1);
+		state_word fresh = adopt(new_value, std::default_delete<T>(), std::allocator<T>());
+		release(exchange(fresh));
 	}
 private:
-	struct value_container {
-		std::atomic_int counter;
-		T* const ptr;
+	typedef smart_ptr_detail::state_word state_word;
+
+	static const int taken_shift = 48;
+	static const state_word taken_one = state_word(1) << taken_shift;
+	static const state_word word_mask = taken_one - 1;
+	static const state_word inline_bit = 1;
+	static const state_word address_mask = word_mask & ~inline_bit;
 
-		value_container(T * ptr)
+    /**
+    * Reference counters shared by all smart_ptr and weak_smart_ptr instances of a value.
+    * Weak counter is the number of weak references plus one while there are strong ones.
+    */
+	struct counted_block : Policy::hook_type {
+		typename Policy::counter_type counter;
+		typename Policy::counter_type weak;
+
+		counted_block()
 			: counter(1)
-			, ptr(ptr)
+			, weak(1)
+		{
+			SMART_PTR_STATS_ADD(T, created, 1);
+#ifdef SMART_PTR_STATS
+			created_at = std::chrono::steady_clock::now();
+#endif
+		}
+
+        /**
+        * Destroys the value, called when last strong reference is dropped
+        */
+		virtual void dispose() = 0;
+
+        /**
+        * Frees the control block, called when last weak reference is dropped
+        */
+		virtual void destroy() = 0;
+
+		void release_weak() {
+			if (Policy::add(weak, -1) == 0)
+				destroy();
+		}
+
+		void reclaim() {
+#ifdef SMART_PTR_STATS
+			std::chrono::nanoseconds lifetime = std::chrono::steady_clock::now() - created_at;
+			SMART_PTR_STATS_ADD(T, destroyed, 1);
+			SMART_PTR_STATS_ADD(T, lifetime_ns, static_cast<size_t>(lifetime.count()));
+#endif
+			dispose();
+			release_weak();
+		}
+	protected:
+		~counted_block() = default;
+
+#ifdef SMART_PTR_STATS
+		std::chrono::steady_clock::time_point created_at;
+#endif
+	};
+
+	template<typename Block, typename Alloc>
+	using block_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<Block>;
+
+	template<typename Block, typename Alloc>
+	static void free_block(Block* value, Alloc const& alloc) {
+		block_allocator<Block, Alloc> allocator(alloc);
+		value->~Block();
+		std::allocator_traits<block_allocator<Block, Alloc>>::deallocate(allocator, value, 1);
+	}
+
+	struct pointer_block : counted_block {
+		T* const ptr;
+
+		pointer_block(T * ptr)
+			: ptr(ptr)
+		{}
+	};
+
+	template<typename D, typename Alloc>
+	struct deleter_block : pointer_block {
+		D deleter;
+		Alloc alloc;
+
+		deleter_block(T * ptr, D const& deleter, Alloc const& alloc)
+			: pointer_block(ptr)
+			, deleter(deleter)
+			, alloc(alloc)
+		{}
+
+		void dispose() override {
+			deleter(this->ptr);
+		}
+
+		void destroy() override {
+			Alloc copy(alloc);
+			free_block(this, copy);
+		}
+	};
+
+	struct inline_storage : counted_block {
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+		T* get() {
+			return reinterpret_cast<T*>(&storage);
+		}
+	};
+
+	template<typename Alloc>
+	struct inline_block : inline_storage {
+		Alloc alloc;
+
+		inline_block(Alloc const& alloc)
+			: alloc(alloc)
 		{}
+
+		void dispose() override {
+			block_allocator<T, Alloc> allocator(alloc);
+			std::allocator_traits<block_allocator<T, Alloc>>::destroy(allocator, this->get());
+		}
+
+		void destroy() override {
+			Alloc copy(alloc);
+			free_block(this, copy);
+		}
 	};
 
-	value_container* value;
-	mutable std::mutex mutex;
+	struct adopt_tag {};
+
+	smart_ptr(state_word word, adopt_tag)
+		: state(word)
+	{}
+
+	template<typename D, typename Alloc>
+	static state_word adopt(T * ptr, D deleter, Alloc const& alloc) {
+		if (ptr == nullptr)
+			return 0;
+		typedef deleter_block<D, Alloc> block_t;
+		block_allocator<block_t, Alloc> allocator(alloc);
+		block_t* value;
+		try {
+			value = std::allocator_traits<block_allocator<block_t, Alloc>>::allocate(allocator, 1);
+		} catch (...) {
+			deleter(ptr);
+			throw;
+		}
+		new (value) block_t(ptr, deleter, alloc);
+		return reinterpret_cast<uintptr_t>(static_cast<counted_block*>(value));
+	}
+
+	static counted_block* block(state_word state) {
+		return reinterpret_cast<counted_block*>(static_cast<uintptr_t>(state & address_mask));
+	}
+
+	static T* pointer(state_word state) {
+		counted_block* value = block(state);
+		if (value == nullptr)
+			return nullptr;
+		if (state & inline_bit)
+			return static_cast<inline_storage*>(value)->get();
+		return static_cast<pointer_block*>(value)->ptr;
+	}
+
+    /**
+    * Makes a new reference to the current value. Announces the copy in the instance's taken count, so the value
+    * can't be destroyed before the global counter is increased, then withdraws the announcement, or, if
+    * the value has been swapped out meanwhile, returns the reference the swapping thread transferred for it.
+    */
+	state_word acquire() const {
+		SMART_PTR_STATS_ADD(T, copies, 1);
+		if (!Policy::concurrent) {
+			state_word word = state.load(std::memory_order_relaxed);
+			if (block(word) != nullptr)
+				Policy::increment(block(word)->counter);
+			return word;
+		}
+
+		state_word taken = state.fetch_add(taken_one, std::memory_order_acquire) + taken_one;
+		counted_block* value = block(taken);
+		if (value != nullptr)
+			Policy::increment(value->counter);
+
+		state_word current = taken;
+		while (block(current) == value && current >= taken_one) {
+			if (state.compare_exchange_weak(current, current - taken_one, std::memory_order_acq_rel))
+				return taken & word_mask;
+			SMART_PTR_STATS_ADD(T, contention, 1);
+		}
+		SMART_PTR_STATS_ADD(T, contention, 1);
+		if (value != nullptr)
+			Policy::add(value->counter, -1);
+		return taken & word_mask;
+	}
+
+    /**
+    * Turns copies in flight of a swapped out state into references in the global counter
+    * @return the state without copies in flight
+    */
+	static state_word settle(state_word old) {
+		counted_block* value = block(old);
+		int taken = static_cast<int>(old >> taken_shift);
+		if (value != nullptr && taken != 0)
+			Policy::increment(value->counter, taken);
+		return old & word_mask;
+	}
+
+    /**
+    * Drops the reference held by a swapped out state, destroying the value if it was the last one
+    */
+	static void release(state_word old) {
+		counted_block* value = block(old);
+		if (value == nullptr)
+			return;
+		int taken = static_cast<int>(old >> taken_shift);
+		if (Policy::add(value->counter, taken - 1) != 0)
+			return;
+		finish(value, std::integral_constant<bool, Policy::deferred>());
+	}
+
+	static void finish(counted_block* value, std::false_type) {
+		value->reclaim();
+	}
+
+	static void finish(counted_block* value, std::true_type) {
+		smart_ptr_detail::retire(value);
+	}
+
+    /**
+    * Replaces the state of this instance
+    * @return previous state
+    */
+	state_word exchange(state_word fresh) {
+		if (Policy::concurrent)
+			return state.exchange(fresh, std::memory_order_acq_rel);
+		state_word old = state.load(std::memory_order_relaxed);
+		state.store(fresh, std::memory_order_relaxed);
+		return old;
+	}
+
+	mutable std::atomic<state_word> state;
 };
 
 /**
-* Creates smart_ptr with pointer obtained by calling given type's constructor with given arguments.
+* Creates smart_ptr with value constructed by given type's constructor with given arguments.
+* Value and control block share one allocation obtained from given allocator.
+* @param alloc allocator for the value and the control block
 * @tparam T type of underlying value
+* @tparam Policy reference counting policy
+* @tparam Alloc type of allocator
 * @tparam Args arguments types
 */
-template<typename T, typename... Args>
-smart_ptr<T> make_smart(Args&&... args) {
-	return smart_ptr<T>(new T(std::forward<Args>(args)...));
-}
\ No newline at end of file
+template<typename T, typename Policy, typename Alloc, typename... Args>
+smart_ptr<T, Policy> allocate_smart(Alloc const& alloc, Args&&... args) {
+	typedef smart_ptr<T, Policy> smart_ptr_t;
+	typedef typename smart_ptr_t::template inline_block<Alloc> block_t;
+	typedef typename smart_ptr_t::template block_allocator<block_t, Alloc> block_allocator_t;
+	typedef typename smart_ptr_t::template block_allocator<T, Alloc> value_allocator_t;
+	block_allocator_t allocator(alloc);
+	block_t* value = std::allocator_traits<block_allocator_t>::allocate(allocator, 1);
+	new (value) block_t(alloc);
+	try {
+		value_allocator_t value_allocator(alloc);
+		std::allocator_traits<value_allocator_t>::construct(value_allocator, value->get(), std::forward<Args>(args)...);
+	} catch (...) {
+		smart_ptr_t::free_block(value, alloc);
+		throw;
+	}
+	smart_ptr_detail::state_word word = reinterpret_cast<uintptr_t>(static_cast<typename smart_ptr_t::counted_block*>(value));
+	return smart_ptr_t(word | smart_ptr_t::inline_bit, typename smart_ptr_t::adopt_tag());
+}
+
+/**
+* Creates smart_ptr with value constructed by given type's constructor with given arguments.
+* Value and reference counters share one allocation.
+* @tparam T type of underlying value
+* @tparam Policy reference counting policy
+* @tparam Args arguments types
+*/
+template<typename T, typename Policy = atomic_counting, typename... Args>
+smart_ptr<T, Policy> make_smart(Args&&... args) {
+	return allocate_smart<T, Policy>(std::allocator<T>(), std::forward<Args>(args)...);
+}
+
+/**
+* Non-owning reference to a value managed by smart_ptr. Doesn't keep the value alive,
+* but keeps it's control block so that lock() can check whether the value still exists.
+* Like intrusive_smart_ptr, one instance must not be assigned while it's copied or locked.
+* @tparam T type of underlying value
+* @tparam Policy reference counting policy of the owners
+*/
+template<typename T, typename Policy = atomic_counting>
+class weak_smart_ptr {
+	typedef smart_ptr<T, Policy> smart_ptr_t;
+	typedef typename smart_ptr_t::counted_block counted_block;
+public:
+    /**
+    * Constructs weak reference to nothing
+    */
+	weak_smart_ptr()
+		: word(0)
+	{}
+
+    /**
+    * Constructs weak reference to the value of given smart_ptr
+    * @param ptr owner of the value
+    */
+	weak_smart_ptr(smart_ptr_t const& ptr)
+		: word(ptr.acquire())
+	{
+		counted_block* value = smart_ptr_t::block(word);
+		if (value != nullptr) {
+			Policy::increment(value->weak);
+			smart_ptr_t::release(word);
+		}
+	}
+
+    /**
+    * Copies given weak reference
+    * @param orig value to copy
+    */
+	weak_smart_ptr(weak_smart_ptr const& orig)
+		: word(orig.word)
+	{
+		counted_block* value = smart_ptr_t::block(word);
+		if (value != nullptr)
+			Policy::increment(value->weak);
+	}
+
+    /**
+    * Moves given weak reference to newly constructed one
+    * @param orig value to move
+    */
+	weak_smart_ptr(weak_smart_ptr && orig)
+		: word(orig.word)
+	{
+		orig.word = 0;
+	}
+
+    /**
+    * Destroys this weak reference, freeing the control block if it was the last reference of any kind
+    */
+	~weak_smart_ptr() {
+		reset();
+	}
+
+    /**
+    * Assigns given weak reference to this
+    * @param other value to assign
+    * @return this
+    */
+	weak_smart_ptr& operator=(weak_smart_ptr other) {
+		std::swap(word, other.word);
+		return *this;
+	}
+
+    /**
+    * Drops the reference
+    */
+	void reset() {
+		counted_block* value = smart_ptr_t::block(word);
+		word = 0;
+		if (value != nullptr)
+			value->release_weak();
+	}
+
+    /**
+    * Checks if the value has been destroyed
+    * @return true if there are no smart_ptr owning the value, false otherwise
+    */
+	bool expired() const {
+		counted_block* value = smart_ptr_t::block(word);
+		return value == nullptr || Policy::load(value->counter) == 0;
+	}
+
+    /**
+    * Obtains strong reference to the value if it still exists without locking:
+    * the strong counter is increased only if it isn't zero.
+    * @return smart_ptr owning the value, or empty smart_ptr if the value has been destroyed
+    */
+	smart_ptr_t lock() const {
+		counted_block* value = smart_ptr_t::block(word);
+		if (value == nullptr)
+			return smart_ptr_t();
+		if (!Policy::increment_if_not_zero(value->counter))
+			return smart_ptr_t();
+		return smart_ptr_t(word, typename smart_ptr_t::adopt_tag());
+	}
+private:
+	smart_ptr_detail::state_word word;
+};
+
+/**
+* Shared smart_ptr slot with lock-free atomic operations, e.g. to publish snapshots of configuration
+* to readers on hot paths. Loads use the same split reference count as smart_ptr copies, so a loaded value
+* stays alive even if it's replaced concurrently.
+* @tparam T type of underlying value
+*/
+template<typename T>
+class atomic_smart_ptr {
+	typedef smart_ptr<T, atomic_counting> smart_ptr_t;
+public:
+    /**
+    * Constructs slot with given value
+    * @param desired initial value
+    */
+	atomic_smart_ptr(smart_ptr_t desired = smart_ptr_t())
+		: value(std::move(desired))
+	{}
+
+	atomic_smart_ptr(atomic_smart_ptr const&) = delete;
+	atomic_smart_ptr& operator=(atomic_smart_ptr const&) = delete;
+
+    /**
+    * Checks if operations are lock-free
+    * @return true
+    */
+	bool is_lock_free() const {
+		return true;
+	}
+
+    /**
+    * Obtains a reference to the current value
+    * @return current value
+    */
+	smart_ptr_t load() const {
+		return smart_ptr_t(value.acquire(), typename smart_ptr_t::adopt_tag());
+	}
+
+    /**
+    * Obtains a reference to the current value
+    * @return current value
+    */
+	operator smart_ptr_t() const {
+		return load();
+	}
+
+    /**
+    * Replaces the current value
+    * @param desired new value
+    */
+	void store(smart_ptr_t desired) {
+		SMART_PTR_STATS_ADD(T, resets, 1);
+		smart_ptr_t::release(value.exchange(take(desired)));
+	}
+
+    /**
+    * Replaces the current value
+    * @param desired new value
+    * @return this
+    */
+	atomic_smart_ptr& operator=(smart_ptr_t desired) {
+		store(std::move(desired));
+		return *this;
+	}
+
+    /**
+    * Replaces the current value
+    * @param desired new value
+    * @return previous value
+    */
+	smart_ptr_t exchange(smart_ptr_t desired) {
+		SMART_PTR_STATS_ADD(T, resets, 1);
+		smart_ptr_detail::state_word old = smart_ptr_t::settle(value.exchange(take(desired)));
+		return smart_ptr_t(old, typename smart_ptr_t::adopt_tag());
+	}
+
+    /**
+    * Replaces the current value with desired one if it's the same control block as expected one,
+    * otherwise loads the current value into expected
+    * @param expected value which is assumed to be current, receives the current value on failure
+    * @param desired new value
+    * @return true if value was replaced, false otherwise
+    */
+	bool compare_exchange_strong(smart_ptr_t& expected, smart_ptr_t desired) {
+		smart_ptr_detail::state_word assumed = expected.state.load(std::memory_order_relaxed);
+		smart_ptr_detail::state_word fresh = desired.state.load(std::memory_order_relaxed);
+		smart_ptr_detail::state_word current = value.state.load(std::memory_order_relaxed);
+		while ((current & smart_ptr_t::word_mask) == assumed) {
+			if (value.state.compare_exchange_weak(current, fresh, std::memory_order_acq_rel)) {
+				desired.state.store(0, std::memory_order_relaxed);
+				smart_ptr_t::release(current);
+				SMART_PTR_STATS_ADD(T, resets, 1);
+				return true;
+			}
+			SMART_PTR_STATS_ADD(T, contention, 1);
+		}
+		SMART_PTR_STATS_ADD(T, contention, 1);
+		expected = load();
+		return false;
+	}
+
+    /**
+    * Same as compare_exchange_strong, which never fails spuriously
+    * @param expected value which is assumed to be current, receives the current value on failure
+    * @param desired new value
+    * @return true if value was replaced, false otherwise
+    */
+	bool compare_exchange_weak(smart_ptr_t& expected, smart_ptr_t desired) {
+		return compare_exchange_strong(expected, std::move(desired));
+	}
+private:
+	static smart_ptr_detail::state_word take(smart_ptr_t& ptr) {
+		return ptr.state.exchange(0, std::memory_order_relaxed);
+	}
+
+	smart_ptr_t value;
+};
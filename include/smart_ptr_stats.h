@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <ostream>
+#include <algorithm>
+
+/**
+* Usage counters of smart_ptr instances of one value type.
+* Counting is compiled in only when SMART_PTR_STATS is defined, otherwise all counters stay zero
+* and instrumentation points compile to nothing.
+*/
+struct smart_ptr_stats {
+    /**
+    * Number of copies of smart_ptr instances, including loads of atomic_smart_ptr
+    */
+	size_t copies = 0;
+
+    /**
+    * Number of assignments and resets, destruction isn't counted
+    */
+	size_t resets = 0;
+
+    /**
+    * Number of calls to get(), operator* and operator->
+    */
+	size_t dereferences = 0;
+
+    /**
+    * Number of failed compare-and-swap attempts and copies racing with assignment of the same instance
+    */
+	size_t contention = 0;
+
+    /**
+    * Number of values which got a control block
+    */
+	size_t created = 0;
+
+    /**
+    * Number of destroyed values
+    */
+	size_t destroyed = 0;
+
+    /**
+    * Sum of lifetimes of destroyed values in nanoseconds
+    */
+	size_t lifetime_ns = 0;
+};
+
+namespace smart_ptr_detail {
+    /**
+    * Counters of one thread. Only the owner thread writes them, so relaxed load and store
+    * are enough and other threads can read them while aggregating.
+    */
+	struct stats_counters {
+		std::atomic<size_t> copies;
+		std::atomic<size_t> resets;
+		std::atomic<size_t> dereferences;
+		std::atomic<size_t> contention;
+		std::atomic<size_t> created;
+		std::atomic<size_t> destroyed;
+		std::atomic<size_t> lifetime_ns;
+
+		stats_counters()
+			: copies(0), resets(0), dereferences(0), contention(0), created(0), destroyed(0), lifetime_ns(0)
+		{}
+
+		static void add(std::atomic<size_t>& counter, size_t value) {
+			counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		}
+
+		void add_to(smart_ptr_stats& stats) const {
+			stats.copies += copies.load(std::memory_order_relaxed);
+			stats.resets += resets.load(std::memory_order_relaxed);
+			stats.dereferences += dereferences.load(std::memory_order_relaxed);
+			stats.contention += contention.load(std::memory_order_relaxed);
+			stats.created += created.load(std::memory_order_relaxed);
+			stats.destroyed += destroyed.load(std::memory_order_relaxed);
+			stats.lifetime_ns += lifetime_ns.load(std::memory_order_relaxed);
+		}
+	};
+
+    /**
+    * Counters of all threads for one value type. Threads register on their first event,
+    * counters of exited threads are merged into the totals.
+    * @tparam T type of values
+    */
+	template<typename T>
+	class stats_registry {
+	public:
+		static stats_registry& instance() {
+			static stats_registry registry;
+			return registry;
+		}
+
+		static stats_counters& local() {
+			struct registration {
+				stats_counters counters;
+
+				registration() {
+					instance().add(&counters);
+				}
+
+				~registration() {
+					instance().remove(&counters);
+				}
+			};
+			static thread_local registration current;
+			return current.counters;
+		}
+
+		smart_ptr_stats collect() {
+			std::lock_guard<std::mutex> lock(mutex);
+			smart_ptr_stats stats = finished;
+			for (stats_counters const* counters : threads)
+				counters->add_to(stats);
+			return stats;
+		}
+	private:
+		void add(stats_counters* counters) {
+			std::lock_guard<std::mutex> lock(mutex);
+			threads.push_back(counters);
+		}
+
+		void remove(stats_counters* counters) {
+			std::lock_guard<std::mutex> lock(mutex);
+			counters->add_to(finished);
+			threads.erase(std::find(threads.begin(), threads.end(), counters));
+		}
+
+		std::mutex mutex;
+		std::vector<stats_counters const*> threads;
+		smart_ptr_stats finished;
+	};
+}
+
+#ifdef SMART_PTR_STATS
+#define SMART_PTR_STATS_ADD(T, field, value) \
+	(smart_ptr_detail::stats_counters::add(smart_ptr_detail::stats_registry<T>::local().field, (value)))
+#else
+#define SMART_PTR_STATS_ADD(T, field, value) ((void) 0)
+#endif
+
+/**
+* Returns counters of smart_ptr instances with given value type summed over all threads
+* @tparam T type of values
+* @return counters since the program start
+*/
+template<typename T>
+smart_ptr_stats get_smart_ptr_stats() {
+	return smart_ptr_detail::stats_registry<T>::instance().collect();
+}
+
+/**
+* Prints counters of smart_ptr instances with given value type in one line
+* @param out stream to print to
+* @param name of the type to print
+* @tparam T type of values
+*/
+template<typename T>
+void dump_smart_ptr_stats(std::ostream& out, std::string const& name) {
+	smart_ptr_stats stats = get_smart_ptr_stats<T>();
+	out << name << ": copies " << stats.copies << " resets " << stats.resets
+		<< " dereferences " << stats.dereferences << " contention " << stats.contention
+		<< " created " << stats.created << " destroyed " << stats.destroyed
+		<< " mean lifetime " << (stats.destroyed == 0 ? 0 : stats.lifetime_ns / stats.destroyed) << " ns" << std::endl;
+}
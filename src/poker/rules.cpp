@@ -1,80 +1,81 @@
 #include <poker/rules.h>
 
-#include <numeric>
-#include <algorithm>
 #include <stdexcept>
 
 namespace poker {
     namespace {
-        bool has_straight(hand_t const& hand) {
-            bool exists[card_rank::ACE + 1] = {false};
-            for (card_t const& card : hand.get_cards()) {
-                exists[card.get_rank()] = true;
-            }
-            for (size_t i = 0; i <= card_rank::ACE; ++i) {
-                if (exists[i]) {
-                    for (size_t j = i; j < i + 5; ++j) {
-                        if (!exists[j])
-                            return false;
+        size_t const RANKS_COUNT = card_rank::ACE + 1;
+
+        /**
+        * Properties of each set of ranks given as 13-bit mask, precomputed for all 8192 masks
+        */
+        struct rank_tables {
+            // ranks of the set packed into nibbles in descending order
+            uint32_t packed[1 << RANKS_COUNT];
+            // number of ranks in the set
+            uint8_t size[1 << RANKS_COUNT];
+            // whether the lowest rank of the set and four ranks above it are all in the set
+            bool straight[1 << RANKS_COUNT];
+
+            rank_tables() {
+                for (uint32_t mask = 0; mask < (1u << RANKS_COUNT); ++mask) {
+                    packed[mask] = 0;
+                    size[mask] = 0;
+                    for (uint32_t rank = RANKS_COUNT; rank-- > 0; ) {
+                        if (mask & (1u << rank)) {
+                            packed[mask] = (packed[mask] << 4) | rank;
+                            size[mask]++;
+                        }
                     }
-                    return true;
+                    uint32_t lowest = mask & (~mask + 1);
+                    straight[mask] = mask != 0 && (mask & (lowest * 0x1F)) == lowest * 0x1F;
                 }
             }
-            throw std::runtime_error("unreachable");
-        }
+        };
 
-        bool has_flush(hand_t const& hand) {
-            auto const& cards = hand.get_cards();
-            card_suit suit = cards.front().get_suit();
-            for (card_t const& card : cards) {
-                if (card.get_suit() != suit)
-                    return false;
-            }
-            return true;
+        rank_tables const& get_rank_tables() {
+            static rank_tables const tables;
+            return tables;
         }
+    }
 
-        uint32_t calc_rank_mask(std::vector<std::vector<card_rank>> mults) {
-            uint32_t result = 0;
-            for (size_t i = 4; i > 0; --i) {
-                std::sort(mults[i].begin(), mults[i].end());
-                result = std::accumulate(mults[i].rbegin(), mults[i].rend(), result, [](uint32_t mask, card_rank rank) {
-                    return (mask << 4) | rank;
-                });
-            }
-            return result;
-        }
+    uint32_t simple_rules::get_combination_rank(hand_t const& hand) {
+        rank_tables const& tables = get_rank_tables();
 
-        std::vector<std::vector<card_rank>> calc_mults(hand_t const& hand) {
-            size_t count[card_rank::ACE + 1] = {0};
-            for (card_t const& card : hand.get_cards()) {
-                count[card.get_rank()]++;
-            }
-            std::vector<std::vector<card_rank>> mults(5);
-            for (size_t i = 0; i <= card_rank::ACE; ++i) {
-                mults[count[i]].push_back(static_cast<card_rank>(i));
-            }
-            return mults;
+        // at_least[k] is the mask of ranks occurring at least k + 1 times
+        uint32_t at_least[4] = {0, 0, 0, 0};
+        uint32_t suits = 0;
+        for (card_t const& card : hand.get_cards()) {
+            uint32_t bit = 1u << card.get_rank();
+            at_least[3] |= at_least[2] & bit;
+            at_least[2] |= at_least[1] & bit;
+            at_least[1] |= at_least[0] & bit;
+            at_least[0] |= bit;
+            suits |= 1u << card.get_suit();
         }
-    }
+        uint32_t mults[5] = {0, at_least[0] & ~at_least[1], at_least[1] & ~at_least[2],
+                             at_least[2] & ~at_least[3], at_least[3]};
 
-    uint32_t simple_rules::get_combination_rank(hand_t const& hand) {
-        auto mults = calc_mults(hand);
-        bool straight = has_straight(hand);
-        bool flush = has_flush(hand);
-        uint32_t rank_mask = calc_rank_mask(mults);
+        uint64_t ranks = 0;
+        for (size_t i = 4; i > 0; --i)
+            ranks = (ranks << (4 * tables.size[mults[i]])) | tables.packed[mults[i]];
+        uint32_t rank_mask = static_cast<uint32_t>(ranks);
+
+        bool straight = tables.straight[at_least[0]];
+        bool flush = (suits & (suits - 1)) == 0;
         if (straight && flush)
             return STRAIGHT_FLUSH | rank_mask;
-        if (!mults[4].empty())
+        if (mults[4] != 0)
             return QUADS | rank_mask;
-        if (!mults[3].empty() && !mults[2].empty())
+        if (mults[3] != 0 && mults[2] != 0)
             return FULL_HOUSE | rank_mask;
         if (flush)
             return FLUSH | rank_mask;
         if (straight)
             return STRAIGHT | rank_mask;
-        if (!mults[3].empty())
+        if (mults[3] != 0)
             return SET | rank_mask;
-        switch (mults[2].size()) {
+        switch (tables.size[mults[2]]) {
             case 2:
                 return TWO_PAIRS | rank_mask;
             case 1:
@@ -3,8 +3,22 @@
 #include <boost/test/unit_test.hpp>
 
 #include <graph.h>
+#include <graph/shortest_paths.h>
+#include <graph/components.h>
+#include <graph/pagerank.h>
+#include <graph/concurrent.h>
+#include <graph/reorder.h>
+#include <graph/search.h>
+#include <graph/triangles.h>
+#include <graph/kcore.h>
+#include <graph/compressed.h>
+#include <graph/reachability.h>
+#include <thread>
+#include <atomic>
 #include <set>
 #include <queue>
+#include <random>
+#include <cstdio>
 
 BOOST_AUTO_TEST_CASE(test_nodes_manipulation)
 {
@@ -81,6 +95,208 @@ BOOST_AUTO_TEST_CASE(test_edges_manipulation)
     BOOST_CHECK_EQUAL(visited.size(), 1);
 }
 
+BOOST_AUTO_TEST_CASE(test_in_edges)
+{
+    graph_t<int> g;
+    typedef decltype(g)::edge_handle edge_handle;
+
+    auto a = g.add_node();
+    auto b = g.add_node();
+    auto c = g.add_node();
+
+    auto d = g.add_edge(a, b);
+    auto e = g.add_edge(c, b);
+
+    BOOST_CHECK(!g.has_in_index());
+    std::set<edge_handle> visited;
+    g.for_each_in_edge(b, [&visited](edge_handle const& handle) {
+        BOOST_CHECK(visited.insert(handle).second);
+    });
+    BOOST_CHECK(g.has_in_index());
+    BOOST_CHECK(visited == std::set<edge_handle>({d, e}));
+
+    auto f = g.add_node();
+    auto h = g.add_edge(b, f);
+    auto i = g.add_edge(f, f);
+    visited.clear();
+    g.for_each_in_edge(f, [&visited](edge_handle const& handle) {
+        BOOST_CHECK(visited.insert(handle).second);
+    });
+    BOOST_CHECK(visited == std::set<edge_handle>({h, i}));
+
+    g.for_each_in_edge(a, [](edge_handle const& handle) {
+        BOOST_FAIL("must not enter here");
+    });
+
+    g.drop_in_index();
+    BOOST_CHECK(!g.has_in_index());
+    visited.clear();
+    g.for_each_in_edge(b, [&visited](edge_handle const& handle) {
+        BOOST_CHECK(visited.insert(handle).second);
+    });
+    BOOST_CHECK(visited == std::set<edge_handle>({d, e}));
+}
+
+BOOST_AUTO_TEST_CASE(test_in_edges_concurrent)
+{
+    graph_t<int> g;
+    size_t n = 1000;
+    for (size_t i = 0; i < n; ++i)
+        g.add_node();
+    for (size_t i = 0; i < n; ++i) {
+        g.add_edge(i, (i + 1) % n);
+        g.add_edge(i, (i * 7) % n);
+    }
+
+    graph_t<int> const& shared = g;
+    std::atomic<size_t> errors(0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.push_back(std::thread([&shared, &errors, n]() {
+            size_t in_edges = 0;
+            for (size_t node = 0; node < n; ++node)
+                shared.for_each_in_edge(node, [&](size_t edge) {
+                    if (shared.get_target(edge) != node)
+                        ++errors;
+                    ++in_edges;
+                });
+            if (in_edges != 2 * n)
+                ++errors;
+        }));
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    BOOST_CHECK_EQUAL(errors.load(), 0);
+    BOOST_CHECK(g.has_in_index());
+}
+
+BOOST_AUTO_TEST_CASE(test_removal)
+{
+    graph_t<std::string, int> g;
+    typedef decltype(g)::node_handle node_handle;
+    typedef decltype(g)::edge_handle edge_handle;
+
+    auto a = g.add_node();
+    auto b = g.add_node();
+    auto c = g.add_node();
+    auto d = g.add_node();
+    g[a] = "a";
+    g[b] = "b";
+    g[c] = "c";
+    g[d] = "d";
+
+    auto ab = g.add_edge(a, b, 1);
+    auto ac = g.add_edge(a, c, 2);
+    auto bc = g.add_edge(b, c, 3);
+    auto cd = g.add_edge(c, d, 4);
+    auto da = g.add_edge(d, a, 5);
+
+    g.remove_edge(ac);
+    BOOST_CHECK(!g.has_edge(ac));
+    BOOST_CHECK_THROW(g.remove_edge(ac), std::runtime_error);
+    BOOST_CHECK_THROW(g.move(a, ac), std::runtime_error);
+
+    g.remove_node(b);
+    BOOST_CHECK(!g.has_node(b));
+    BOOST_CHECK(!g.has_edge(ab));
+    BOOST_CHECK(!g.has_edge(bc));
+    BOOST_CHECK(g.has_edge(cd));
+    BOOST_CHECK_EQUAL(g.get_removed_nodes_count(), 1);
+    BOOST_CHECK_EQUAL(g.get_removed_edges_count(), 1);
+
+    std::set<node_handle> nodes;
+    g.for_each_node([&nodes](node_handle const& node) {
+        nodes.insert(node);
+    });
+    BOOST_CHECK(nodes == std::set<node_handle>({a, c, d}));
+
+    g.for_each_edge(a, [](edge_handle const& handle) {
+        BOOST_FAIL("must not enter here");
+    });
+    g.for_each_in_edge(c, [](edge_handle const& handle) {
+        BOOST_FAIL("must not enter here");
+    });
+
+    std::vector<node_handle> visited;
+    g.dfs(d, [&visited](node_handle const& node) {
+        visited.push_back(node);
+    }, [](node_handle const&) {}, [](node_handle const&) {});
+    BOOST_CHECK(visited == std::vector<node_handle>({d, a}));
+
+    BOOST_CHECK(g.compact(0.5).nodes.empty());
+    auto remapping = g.compact(0.2);
+    BOOST_CHECK(remapping.nodes == std::vector<node_handle>({0, invalid_handle, 1, 2}));
+    BOOST_CHECK(remapping.edges == std::vector<edge_handle>({invalid_handle, invalid_handle, invalid_handle, 0, 1}));
+    BOOST_CHECK_EQUAL(g.get_nodes_count(), 3);
+    BOOST_CHECK_EQUAL(g.get_edges_count(), 2);
+    BOOST_CHECK_EQUAL(g.get_removed_nodes_count(), 0);
+    BOOST_CHECK_EQUAL(g[remapping.nodes[c]], "c");
+    BOOST_CHECK_EQUAL(g.edge_payload(remapping.edges[da]), 5);
+    BOOST_CHECK_EQUAL(g.move(remapping.nodes[c], remapping.edges[cd]), remapping.nodes[d]);
+    BOOST_CHECK_EQUAL(g.get_source(remapping.edges[da]), remapping.nodes[d]);
+    BOOST_CHECK_EQUAL(g.get_target(remapping.edges[da]), remapping.nodes[a]);
+    g.for_each_in_edge(remapping.nodes[a], [&](edge_handle const& handle) {
+        BOOST_CHECK_EQUAL(handle, remapping.edges[da]);
+    });
+}
+
+BOOST_AUTO_TEST_CASE(test_bulk_construction)
+{
+    typedef graph_t<int, int> graph;
+    typedef graph::edge_handle edge_handle;
+
+    std::vector<std::tuple<size_t, size_t, int>> list = {
+        std::make_tuple(0, 1, 10),
+        std::make_tuple(2, 1, 20),
+        std::make_tuple(0, 2, 30)
+    };
+    auto g = graph::from_edge_list(3, list);
+
+    graph h;
+    h.reserve_nodes(3);
+    h.reserve_edges(3);
+    auto a = h.add_node();
+    auto b = h.add_node();
+    auto c = h.add_node();
+    h.add_edge(a, b, 10);
+    h.add_edge(c, b, 20);
+    h.add_edge(a, c, 30);
+    BOOST_CHECK(g == h);
+
+    std::vector<std::pair<size_t, size_t>> more = {std::make_pair(b, c), std::make_pair(c, a)};
+    auto first = g.add_edges(more);
+    BOOST_CHECK_EQUAL(first, 3);
+    BOOST_CHECK_EQUAL(g.get_edges_count(), 5);
+    BOOST_CHECK_EQUAL(g.move(b, first), c);
+    BOOST_CHECK_EQUAL(g.move(c, first + 1), a);
+    BOOST_CHECK_EQUAL(g.edge_payload(first), 0);
+
+    more.push_back(std::make_pair(a, 7));
+    BOOST_CHECK_THROW(g.add_edges(more), std::runtime_error);
+    BOOST_CHECK_EQUAL(g.get_edges_count(), 5);
+    BOOST_CHECK_THROW(graph::from_edge_list(2, list), std::runtime_error);
+
+    std::mt19937 random(3);
+    size_t n = 10000;
+    std::uniform_int_distribution<size_t> node(0, n - 1);
+    std::vector<std::pair<size_t, size_t>> edges;
+    for (size_t i = 0; i < 300000; ++i)
+        edges.push_back(std::make_pair(node(random), node(random)));
+    auto sequential = graph::from_edge_list(n, edges);
+    auto parallel = graph::from_edge_list(n, edges, 4);
+    BOOST_CHECK(sequential == parallel);
+    for (size_t source = 0; source < n; ++source) {
+        edge_handle previous = 0;
+        bool first_edge = true;
+        parallel.for_each_edge(source, [&](edge_handle const& edge) {
+            BOOST_CHECK(first_edge || previous < edge);
+            BOOST_CHECK_EQUAL(parallel.get_source(edge), source);
+            previous = edge;
+            first_edge = false;
+        });
+    }
+}
+
 BOOST_AUTO_TEST_CASE(test_dfs)
 {
     graph_t<int> g;
@@ -203,4 +419,954 @@ BOOST_AUTO_TEST_CASE(check_file_operations)
     graph_t<int> h;
     h.load_from_file(filename);
     BOOST_CHECK(g == h);
-}
\ No newline at end of file
+    std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(check_edge_payloads_file_operations)
+{
+    std::string filename = "weighted_graph.txt";
+    graph_t<int, double> g;
+
+    auto a = g.add_node();
+    auto b = g.add_node();
+    auto c = g.add_node();
+
+    auto d = g.add_edge(a, b, 1.5);
+    auto e = g.add_edge(b, c);
+    g.edge_payload(e) = -2.25;
+
+    BOOST_CHECK_EQUAL(g.edge_payload(d), 1.5);
+    BOOST_CHECK_EQUAL(g.get_edges_count(), 2);
+    BOOST_CHECK_EQUAL(g.get_source(e), b);
+    BOOST_CHECK_EQUAL(g.get_target(e), c);
+
+    g.save_to_file(filename);
+
+    graph_t<int, double> h;
+    h.load_from_file(filename);
+    BOOST_CHECK(g == h);
+    std::remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(test_shortest_paths)
+{
+    graph_t<int, int> g;
+
+    auto a = g.add_node();
+    auto b = g.add_node();
+    auto c = g.add_node();
+    auto d = g.add_node();
+    auto e = g.add_node();
+
+    /*
+       4     1
+     a-->b------>d
+     |   ^       ^
+    1|  2|      6|
+     v   |       |
+     c---+------>+
+           9
+     e is unreachable
+     */
+
+    g.add_edge(a, b, 4);
+    auto cb = g.add_edge(c, b, 2);
+    auto ac = g.add_edge(a, c, 1);
+    auto bd = g.add_edge(b, d, 1);
+    g.add_edge(c, d, 9);
+    g.add_edge(d, c, 6);
+
+    auto check = [&](shortest_paths_t<int> const& paths) {
+        BOOST_CHECK_EQUAL(paths.distance[a], 0);
+        BOOST_CHECK_EQUAL(paths.distance[b], 3);
+        BOOST_CHECK_EQUAL(paths.distance[c], 1);
+        BOOST_CHECK_EQUAL(paths.distance[d], 4);
+        BOOST_CHECK_EQUAL(paths.distance[e], shortest_paths_t<int>::unreachable());
+        BOOST_CHECK_EQUAL(paths.parent[a], invalid_handle);
+        BOOST_CHECK_EQUAL(paths.parent[b], cb);
+        BOOST_CHECK_EQUAL(paths.parent[c], ac);
+        BOOST_CHECK_EQUAL(paths.parent[d], bd);
+        BOOST_CHECK_EQUAL(paths.parent[e], invalid_handle);
+    };
+
+    check(dijkstra(g, a));
+    check(delta_stepping(g, a, 1));
+    check(delta_stepping(g, a, 3, 4));
+    check(delta_stepping(g, a, 100));
+
+    BOOST_CHECK_THROW(delta_stepping(g, a, 0), std::runtime_error);
+    BOOST_CHECK_THROW(dijkstra(g, 10), std::runtime_error);
+    g.add_edge(e, a, -1);
+    BOOST_CHECK_THROW(dijkstra(g, a), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_delta_stepping_matches_dijkstra)
+{
+    std::mt19937 random(42);
+    graph_t<int, double> g;
+    size_t n = 5000;
+    for (size_t i = 0; i < n; ++i)
+        g.add_node();
+    std::uniform_int_distribution<size_t> node(0, n - 1);
+    std::uniform_real_distribution<double> weight(0.0, 10.0);
+    for (size_t i = 0; i < 8 * n; ++i)
+        g.add_edge(node(random), node(random), weight(random));
+
+    auto expected = dijkstra(g, 0);
+    auto actual = delta_stepping(g, 0, 2.5, 4);
+    BOOST_CHECK(expected.distance == actual.distance);
+}
+
+BOOST_AUTO_TEST_CASE(test_shortest_paths_large_weights)
+{
+    graph_t<int, int> g;
+    auto a = g.add_node();
+    auto b = g.add_node();
+    auto c = g.add_node();
+    auto d = g.add_node();
+    int large = std::numeric_limits<int>::max() - 10;
+    g.add_edge(a, b, large);
+    g.add_edge(b, c, large);
+    g.add_edge(a, d, 1);
+
+    for (auto const& paths : {dijkstra(g, a), delta_stepping(g, a, large / 4, 2)}) {
+        BOOST_CHECK_EQUAL(paths.distance[b], large);
+        BOOST_CHECK_EQUAL(paths.distance[c], shortest_paths_t<int>::unreachable());
+        BOOST_CHECK_EQUAL(paths.parent[c], invalid_handle);
+        BOOST_CHECK_EQUAL(paths.distance[d], 1);
+    }
+    BOOST_CHECK_THROW(delta_stepping(g, a, 1), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_strongly_connected_components)
+{
+    graph_t<int> g;
+
+    auto a = g.add_node();
+    auto b = g.add_node();
+    auto c = g.add_node();
+    auto d = g.add_node();
+    auto e = g.add_node();
+    auto f = g.add_node();
+
+    /*
+     a<->b-->c<->d-->f
+          \      ^
+           +->e--+
+     */
+
+    g.add_edge(a, b);
+    g.add_edge(b, a);
+    g.add_edge(b, c);
+    g.add_edge(c, d);
+    g.add_edge(d, c);
+    g.add_edge(d, f);
+    g.add_edge(b, e);
+    g.add_edge(e, d);
+
+    auto scc = strongly_connected_components(g);
+    BOOST_CHECK_EQUAL(scc.count, 4);
+    BOOST_CHECK_EQUAL(scc.component[a], scc.component[b]);
+    BOOST_CHECK_EQUAL(scc.component[c], scc.component[d]);
+    BOOST_CHECK_LT(scc.component[a], scc.component[e]);
+    BOOST_CHECK_LT(scc.component[e], scc.component[c]);
+    BOOST_CHECK_LT(scc.component[c], scc.component[f]);
+
+    auto dag = condensation(g);
+    BOOST_CHECK_EQUAL(dag.get_nodes_count(), 4);
+    BOOST_CHECK_EQUAL(dag.get_edges_count(), 4);
+    BOOST_CHECK(dag[scc.component[c]] == std::vector<size_t>({c, d}));
+
+    auto order = topological_sort(dag);
+    std::vector<size_t> position(order.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        position[order[i]] = i;
+    for (size_t node = 0; node < dag.get_nodes_count(); ++node) {
+        dag.for_each_edge(node, [&](size_t edge) {
+            BOOST_CHECK_LT(position[node], position[dag.get_target(edge)]);
+        });
+    }
+
+    BOOST_CHECK_THROW(topological_sort(g), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_strongly_connected_components_deep_path)
+{
+    graph_t<int> g;
+    size_t n = 200000;
+    for (size_t i = 0; i < n; ++i)
+        g.add_node();
+    for (size_t i = 0; i + 1 < n; ++i)
+        g.add_edge(i, i + 1);
+    g.add_edge(n - 1, 0);
+
+    auto scc = strongly_connected_components(g);
+    BOOST_CHECK_EQUAL(scc.count, 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_in_edges_csr)
+{
+    graph_t<int> g;
+    auto a = g.add_node();
+    auto b = g.add_node();
+    auto c = g.add_node();
+    g.add_edge(a, b);
+    auto e = g.add_edge(c, b);
+    g.add_edge(b, c);
+
+    csr_t csr(g, IN_EDGES);
+    BOOST_CHECK_EQUAL(csr.get_degree(a), 0);
+    BOOST_CHECK_EQUAL(csr.get_degree(b), 2);
+    BOOST_CHECK_EQUAL(csr.get_degree(c), 1);
+    BOOST_CHECK_EQUAL(csr.get_target(csr.begin(b) + 1), c);
+    BOOST_CHECK_EQUAL(csr.get_edge(csr.begin(b) + 1), e);
+}
+
+BOOST_AUTO_TEST_CASE(test_pagerank)
+{
+    graph_t<int> g;
+    auto a = g.add_node();
+    auto b = g.add_node();
+    auto c = g.add_node();
+    auto d = g.add_node();
+
+    g.add_edge(a, b);
+    g.add_edge(a, c);
+    g.add_edge(b, c);
+    g.add_edge(c, a);
+
+    auto ranks = pagerank(g, 0.85, 1e-12, 1000, 2);
+    double sum = ranks[a] + ranks[b] + ranks[c] + ranks[d];
+    BOOST_CHECK_CLOSE(sum, 1.0, 1e-6);
+    BOOST_CHECK_GT(ranks[c], ranks[a]);
+    BOOST_CHECK_GT(ranks[a], ranks[b]);
+    BOOST_CHECK_GT(ranks[b], ranks[d]);
+
+    std::mt19937 random(7);
+    graph_t<int> big;
+    size_t n = 20000;
+    for (size_t i = 0; i < n; ++i)
+        big.add_node();
+    std::uniform_int_distribution<size_t> node(0, n - 1);
+    for (size_t i = 0; i < 5 * n; ++i)
+        big.add_edge(node(random), node(random));
+    auto single = pagerank(big, 0.85, 1e-10, 100, 1);
+    auto parallel = pagerank(big, 0.85, 1e-10, 100, 4);
+    for (size_t i = 0; i < n; ++i)
+        BOOST_CHECK_CLOSE(single[i], parallel[i], 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrent_graph)
+{
+    concurrent_graph_t<int> g;
+    typedef decltype(g)::node_handle node_handle;
+
+    auto a = g.add_node(1);
+    auto b = g.add_node(2);
+    auto before = g.snapshot();
+    auto c = g.add_node(3);
+    auto ab = g.add_edge(a, b);
+    auto bc = g.add_edge(b, c);
+    BOOST_CHECK_THROW(g.add_edge(a, 10), std::runtime_error);
+    auto after = g.snapshot();
+
+    BOOST_CHECK_EQUAL(before.get_nodes_count(), 2);
+    BOOST_CHECK_EQUAL(before.get_edges_count(), 0);
+    before.for_each_edge(a, [](size_t) {
+        BOOST_FAIL("must not enter here");
+    });
+    BOOST_CHECK_EQUAL(after.get_nodes_count(), 3);
+    BOOST_CHECK_EQUAL(after.get_edges_count(), 2);
+    BOOST_CHECK_EQUAL(after[c], 3);
+    BOOST_CHECK_EQUAL(after.get_target(ab), b);
+    BOOST_CHECK_EQUAL(after.get_source(bc), b);
+
+    std::vector<node_handle> visited;
+    after.dfs(a, [&visited](node_handle const& node) {
+        visited.push_back(node);
+    }, [](node_handle const&) {}, [](node_handle const&) {});
+    BOOST_CHECK(visited == std::vector<node_handle>({a, b, c}));
+
+    csr_t csr(after);
+    BOOST_CHECK_EQUAL(csr.get_edges_count(), 2);
+    BOOST_CHECK_EQUAL(csr.get_degree(b), 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_concurrent_graph_multithread)
+{
+    concurrent_graph_t<size_t, size_t> g;
+    size_t writers = 4;
+    size_t per_writer = 20000;
+    for (size_t i = 0; i < 16; ++i)
+        g.add_node(i);
+
+    std::atomic<bool> done(false);
+    std::atomic<size_t> errors(0);
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < writers; ++w) {
+        threads.push_back(std::thread([&g, w, per_writer]() {
+            std::mt19937 random(w);
+            for (size_t i = 0; i < per_writer; ++i) {
+                auto snapshot = g.snapshot();
+                std::uniform_int_distribution<size_t> node(0, snapshot.get_nodes_count() - 1);
+                if (i % 4 == 0)
+                    g.add_node(i);
+                else
+                    g.add_edge(node(random), node(random), i);
+            }
+        }));
+    }
+    for (size_t r = 0; r < 2; ++r) {
+        threads.push_back(std::thread([&g, &done, &errors]() {
+            while (!done) {
+                auto snapshot = g.snapshot();
+                size_t edges = 0;
+                snapshot.for_each_node([&](size_t node) {
+                    snapshot.for_each_edge(node, [&](size_t edge) {
+                        ++edges;
+                        if (snapshot.get_source(edge) != node || snapshot.get_target(edge) >= snapshot.get_nodes_count())
+                            ++errors;
+                    });
+                });
+                if (edges != snapshot.get_edges_count())
+                    ++errors;
+            }
+        }));
+    }
+    for (size_t w = 0; w < writers; ++w)
+        threads[w].join();
+    done = true;
+    for (size_t r = writers; r < threads.size(); ++r)
+        threads[r].join();
+
+    BOOST_CHECK_EQUAL(errors, 0);
+    auto snapshot = g.snapshot();
+    BOOST_CHECK_EQUAL(snapshot.get_nodes_count(), 16 + writers * per_writer / 4);
+    BOOST_CHECK_EQUAL(snapshot.get_edges_count(), writers * per_writer * 3 / 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_permute)
+{
+    graph_t<std::string, int> g;
+    auto a = g.add_node();
+    auto b = g.add_node();
+    auto c = g.add_node();
+    g[a] = "a";
+    g[b] = "b";
+    g[c] = "c";
+    auto ab = g.add_edge(a, b, 1);
+    auto ca = g.add_edge(c, a, 2);
+    g.for_each_in_edge(a, [](size_t) {});
+
+    std::vector<size_t> permutation = {2, 0, 1};
+    g.permute(permutation);
+    BOOST_CHECK_EQUAL(g[2], "a");
+    BOOST_CHECK_EQUAL(g[0], "b");
+    BOOST_CHECK_EQUAL(g[1], "c");
+    BOOST_CHECK_EQUAL(g.move(2, ab), 0);
+    BOOST_CHECK_EQUAL(g.move(1, ca), 2);
+    BOOST_CHECK_EQUAL(g.edge_payload(ca), 2);
+    g.for_each_in_edge(2, [ca](size_t edge) {
+        BOOST_CHECK_EQUAL(edge, ca);
+    });
+
+    BOOST_CHECK_THROW(g.permute(std::vector<size_t>({0, 0, 1})), std::runtime_error);
+    BOOST_CHECK_THROW(g.permute(std::vector<size_t>({0, 1})), std::runtime_error);
+}
+
+namespace {
+    size_t bandwidth(graph_t<int> const& g) {
+        size_t result = 0;
+        for (size_t node = 0; node < g.get_nodes_count(); ++node) {
+            g.for_each_edge(node, [&](size_t edge) {
+                size_t target = g.get_target(edge);
+                result = std::max(result, node > target ? node - target : target - node);
+            });
+        }
+        return result;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_orderings)
+{
+    size_t side = 30;
+    std::vector<size_t> shuffle(side * side);
+    for (size_t i = 0; i < shuffle.size(); ++i)
+        shuffle[i] = i;
+    std::mt19937 random(11);
+    std::shuffle(shuffle.begin(), shuffle.end(), random);
+
+    std::vector<std::pair<size_t, size_t>> edges;
+    for (size_t x = 0; x < side; ++x) {
+        for (size_t y = 0; y < side; ++y) {
+            if (x + 1 < side)
+                edges.push_back(std::make_pair(shuffle[x * side + y], shuffle[(x + 1) * side + y]));
+            if (y + 1 < side)
+                edges.push_back(std::make_pair(shuffle[x * side + y], shuffle[x * side + y + 1]));
+        }
+    }
+    auto g = graph_t<int>::from_edge_list(side * side, edges);
+    auto original = bandwidth(g);
+
+    auto rcm = g;
+    rcm.permute(rcm_order(csr_t(rcm)));
+    BOOST_CHECK_LE(bandwidth(rcm), 2 * side);
+    BOOST_CHECK_LT(bandwidth(rcm), original);
+
+    csr_t snapshot(g);
+    auto order = bfs_order(snapshot);
+    BOOST_REQUIRE_EQUAL(order.size(), side * side);
+    std::vector<bool> taken(order.size(), false);
+    for (size_t handle : order) {
+        BOOST_REQUIRE_LT(handle, order.size());
+        BOOST_CHECK(!taken[handle]);
+        taken[handle] = true;
+    }
+
+    std::vector<size_t> level(order.size(), invalid_handle);
+    std::vector<size_t> reached(1, 0);
+    level[0] = 0;
+    for (size_t head = 0; head < reached.size(); ++head) {
+        size_t node = reached[head];
+        for (size_t i = snapshot.begin(node); i < snapshot.end(node); ++i) {
+            size_t next = snapshot.get_target(i);
+            if (level[next] == invalid_handle) {
+                level[next] = level[node] + 1;
+                reached.push_back(next);
+            }
+        }
+    }
+    std::vector<size_t> level_begin, level_end;
+    for (size_t node : reached) {
+        if (level[node] == level_begin.size()) {
+            level_begin.push_back(order[node]);
+            level_end.push_back(order[node]);
+        }
+        level_begin[level[node]] = std::min(level_begin[level[node]], order[node]);
+        level_end[level[node]] = std::max(level_end[level[node]], order[node] + 1);
+    }
+    BOOST_CHECK_EQUAL(order[0], 0);
+    for (size_t d = 0; d < level_begin.size(); ++d) {
+        BOOST_CHECK_EQUAL(level_begin[d], d == 0 ? 0 : level_end[d - 1]);
+        BOOST_CHECK_EQUAL(level_end[d] - level_begin[d],
+            size_t(std::count(level.begin(), level.end(), d)));
+    }
+    BOOST_CHECK_EQUAL(level_end.back(), reached.size());
+    BOOST_CHECK_GT(level_begin.size(), 5);
+
+    auto bfs = g;
+    bfs.permute(order);
+    BOOST_CHECK_EQUAL(bfs.get_edges_count(), g.get_edges_count());
+
+    auto degrees = g;
+    degrees.permute(degree_order(csr_t(degrees)));
+    csr_t sorted(degrees);
+    for (size_t node = 0; node + 1 < sorted.get_nodes_count(); ++node)
+        BOOST_CHECK_GE(sorted.get_degree(node), sorted.get_degree(node + 1));
+}
+
+BOOST_AUTO_TEST_CASE(test_multilevel_partition)
+{
+    size_t clique = 40;
+    std::vector<std::pair<size_t, size_t>> edges;
+    for (size_t half = 0; half < 2; ++half) {
+        for (size_t i = 0; i < clique; ++i) {
+            for (size_t j = 0; j < clique; ++j) {
+                if (i != j)
+                    edges.push_back(std::make_pair(2 * i + half, 2 * j + half));
+            }
+        }
+    }
+    edges.push_back(std::make_pair(0, 1));
+    auto g = graph_t<int>::from_edge_list(2 * clique, edges);
+
+    auto part = multilevel_partition(csr_t(g), 2);
+    size_t cut = 0;
+    for (auto const& edge : edges) {
+        if (part[edge.first] != part[edge.second])
+            ++cut;
+    }
+    BOOST_CHECK_EQUAL(cut, 1);
+
+    auto permutation = partition_order(part);
+    g.permute(permutation);
+    for (size_t node = 0; node < 2 * clique; ++node)
+        BOOST_CHECK_EQUAL(permutation[node] < clique, part[node] == 0);
+    BOOST_CHECK_THROW(multilevel_partition(csr_t(g), 0), std::runtime_error);
+}
+
+namespace {
+    template<typename W>
+    void check_path(graph_t<int, W> const& g, path_t<W> const& path, size_t source, size_t target, W distance) {
+        BOOST_REQUIRE(path.found);
+        BOOST_CHECK_EQUAL(path.distance, distance);
+        size_t node = source;
+        W length = W();
+        for (size_t edge : path.edges) {
+            BOOST_CHECK_EQUAL(g.get_source(edge), node);
+            node = g.get_target(edge);
+            length += g.edge_payload(edge);
+        }
+        BOOST_CHECK_EQUAL(node, target);
+        BOOST_CHECK_EQUAL(length, distance);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_point_to_point_search)
+{
+    size_t side = 40;
+    std::mt19937 random(5);
+    std::uniform_int_distribution<int> weight(1, 9);
+    graph_t<int, int> g;
+    for (size_t i = 0; i < side * side; ++i)
+        g.add_node();
+    for (size_t x = 0; x < side; ++x) {
+        for (size_t y = 0; y < side; ++y) {
+            size_t node = x * side + y;
+            if (x + 1 < side) {
+                g.add_edge(node, node + side, weight(random));
+                g.add_edge(node + side, node, weight(random));
+            }
+            if (y + 1 < side) {
+                g.add_edge(node, node + 1, weight(random));
+                g.add_edge(node + 1, node, weight(random));
+            }
+        }
+    }
+    auto isolated = g.add_node();
+
+    search_workspace<int> workspace;
+    search_workspace<size_t> hops;
+    std::uniform_int_distribution<size_t> node(0, side * side - 1);
+    for (size_t query = 0; query < 20; ++query) {
+        size_t source = node(random);
+        size_t target = node(random);
+        auto expected = dijkstra(g, source);
+        size_t tx = target / side;
+        size_t ty = target % side;
+        auto manhattan = [side, tx, ty](size_t v) {
+            size_t x = v / side;
+            size_t y = v % side;
+            return static_cast<int>((x > tx ? x - tx : tx - x) + (y > ty ? y - ty : ty - y));
+        };
+
+        check_path(g, bidirectional_dijkstra(g, source, target, workspace), source, target, expected.distance[target]);
+        check_path(g, astar(g, source, target, manhattan, workspace), source, target, expected.distance[target]);
+
+        auto path = bidirectional_bfs(g, source, target, hops);
+        BOOST_CHECK(path.found);
+        BOOST_CHECK_EQUAL(path.edges.size(), static_cast<size_t>(manhattan(source)));
+        BOOST_CHECK_EQUAL(path.distance, path.edges.size());
+    }
+
+    BOOST_CHECK(!bidirectional_dijkstra(g, 0, isolated, workspace).found);
+    BOOST_CHECK(!astar(g, 0, isolated, [](size_t) { return 0; }, workspace).found);
+    BOOST_CHECK(!bidirectional_bfs(g, isolated, 0, hops).found);
+    BOOST_CHECK(bidirectional_bfs(g, 3, 3, hops).edges.empty());
+    BOOST_CHECK_THROW(astar(g, 0, isolated + 1, [](size_t) { return 0; }, workspace), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_triangles_and_cores)
+{
+    graph_t<int> g;
+    for (size_t i = 0; i < 6; ++i)
+        g.add_node();
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = i + 1; j < 4; ++j)
+            g.add_edge(i, j);
+    }
+    g.add_edge(1, 0);
+    g.add_edge(2, 2);
+    g.add_edge(3, 4);
+
+    csr_t csr(g);
+    auto triangles = count_triangles(csr, 2);
+    BOOST_CHECK_EQUAL(triangles.total, 4);
+    BOOST_CHECK(triangles.per_node == std::vector<size_t>({3, 3, 3, 3, 0, 0}));
+
+    auto clustering = clustering_coefficients(csr);
+    BOOST_CHECK_CLOSE(clustering[0], 1.0, 1e-9);
+    BOOST_CHECK_CLOSE(clustering[3], 0.5, 1e-9);
+    BOOST_CHECK_EQUAL(clustering[4], 0.0);
+
+    auto cores = core_numbers(csr);
+    BOOST_CHECK(cores == std::vector<size_t>({3, 3, 3, 3, 1, 0}));
+    BOOST_CHECK(k_core(cores, 2) == std::vector<size_t>({0, 1, 2, 3}));
+
+    size_t n = 80;
+    std::mt19937 random(9);
+    std::bernoulli_distribution has_edge(0.3);
+    std::vector<std::vector<bool>> adjacent(n, std::vector<bool>(n, false));
+    graph_t<int> dense;
+    for (size_t i = 0; i < n; ++i)
+        dense.add_node();
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) {
+            if (has_edge(random)) {
+                adjacent[i][j] = adjacent[j][i] = true;
+                if (random() % 2)
+                    dense.add_edge(i, j);
+                else
+                    dense.add_edge(j, i);
+            }
+        }
+    }
+    size_t expected_total = 0;
+    std::vector<size_t> expected(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) {
+            for (size_t k = j + 1; k < n; ++k) {
+                if (adjacent[i][j] && adjacent[j][k] && adjacent[i][k]) {
+                    ++expected_total;
+                    ++expected[i];
+                    ++expected[j];
+                    ++expected[k];
+                }
+            }
+        }
+    }
+    auto actual = count_triangles(csr_t(dense), 4);
+    BOOST_CHECK_EQUAL(actual.total, expected_total);
+    BOOST_CHECK(actual.per_node == expected);
+}
+
+BOOST_AUTO_TEST_CASE(test_weakly_connected_components)
+{
+    graph_t<int> g;
+    for (size_t i = 0; i < 6; ++i)
+        g.add_node();
+    g.add_edge(1, 0);
+    g.add_edge(2, 1);
+    g.add_edge(4, 3);
+    g.add_edge(4, 4);
+
+    auto wcc = weakly_connected_components(g, 2);
+    BOOST_CHECK_EQUAL(wcc.count, 3);
+    BOOST_CHECK(wcc.component == std::vector<size_t>({0, 0, 0, 1, 1, 2}));
+
+    std::mt19937 random(13);
+    size_t n = 100000;
+    std::uniform_int_distribution<size_t> node(0, n - 1);
+    std::vector<std::pair<size_t, size_t>> edges;
+    for (size_t i = 0; i < n / 2; ++i)
+        edges.push_back(std::make_pair(node(random), node(random)));
+    auto big = graph_t<int>::from_edge_list(n, edges);
+    auto actual = weakly_connected_components(big, 4);
+
+    std::vector<std::vector<size_t>> adjacent(n);
+    for (auto const& edge : edges) {
+        adjacent[edge.first].push_back(edge.second);
+        adjacent[edge.second].push_back(edge.first);
+    }
+    std::vector<size_t> expected(n, invalid_handle);
+    size_t count = 0;
+    for (size_t root = 0; root < n; ++root) {
+        if (expected[root] != invalid_handle)
+            continue;
+        std::vector<size_t> queue(1, root);
+        expected[root] = count;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            for (size_t next : adjacent[queue[head]]) {
+                if (expected[next] == invalid_handle) {
+                    expected[next] = count;
+                    queue.push_back(next);
+                }
+            }
+        }
+        ++count;
+    }
+    BOOST_CHECK_EQUAL(actual.count, count);
+    BOOST_CHECK(actual.component == expected);
+}
+
+struct uncopyable_value {
+    uncopyable_value() = default;
+
+    uncopyable_value(uncopyable_value const&) {
+        throw std::runtime_error("copy failed");
+    }
+};
+
+BOOST_AUTO_TEST_CASE(test_attributes)
+{
+    graph_t<int> g;
+    auto a = g.add_node();
+    auto b = g.add_node();
+
+    auto& ages = g.add_node_attribute<int>("age", -1);
+    auto& names = g.add_node_attribute<std::string>("name");
+    BOOST_CHECK_THROW(g.add_node_attribute<int>("age"), std::runtime_error);
+    BOOST_CHECK_THROW(g.node_attribute<double>("age"), std::runtime_error);
+    BOOST_CHECK_THROW(g.node_attribute<int>("height"), std::runtime_error);
+    BOOST_CHECK(g.has_node_attribute("age"));
+    BOOST_CHECK(ages == std::vector<int>({-1, -1}));
+    ages[a] = 30;
+    names[b] = "b";
+
+    auto c = g.add_node();
+    BOOST_CHECK_EQUAL(&g.node_attribute<int>("age"), &ages);
+    BOOST_CHECK(ages == std::vector<int>({30, -1, -1}));
+    BOOST_CHECK_EQUAL(names.size(), 3);
+
+    auto& weights = g.add_edge_attribute<double>("weight", 1.0);
+    auto ab = g.add_edge(a, b);
+    auto bc = g.add_edge(b, c);
+    auto ca = g.add_edge(c, a);
+    std::vector<std::pair<size_t, size_t>> more = {std::make_pair(a, c)};
+    auto ac = g.add_edges(more);
+    BOOST_CHECK_EQUAL(weights.size(), 4);
+    weights[ab] = 2;
+    weights[bc] = 3;
+    weights[ca] = 4;
+    weights[ac] = 10;
+
+    csr_t csr(g);
+    auto paths = dijkstra(csr, csr.arrange(weights), a);
+    BOOST_CHECK_EQUAL(paths.distance[c], 5);
+
+    graph_t<int> copy(g);
+    copy.node_attribute<int>("age")[a] = 31;
+    BOOST_CHECK_EQUAL(ages[a], 30);
+
+    g.remove_node(b);
+    auto remapping = g.compact();
+    BOOST_CHECK(g.node_attribute<int>("age") == std::vector<int>({30, -1}));
+    BOOST_CHECK_EQUAL(g.node_attribute<std::string>("name").size(), 2);
+    BOOST_CHECK(g.edge_attribute<double>("weight") == std::vector<double>({4, 10}));
+    BOOST_CHECK_EQUAL(remapping.edges[ca], 0);
+
+    g.permute(std::vector<size_t>({1, 0}));
+    BOOST_CHECK(g.node_attribute<int>("age") == std::vector<int>({-1, 30}));
+
+    g.remove_node_attribute("age");
+    BOOST_CHECK(!g.has_node_attribute("age"));
+    BOOST_CHECK(copy.has_node_attribute("age"));
+
+    graph_t<int> const& view = copy;
+    static_assert(std::is_same<decltype(view.node_attribute<int>("age")), std::vector<int> const&>::value,
+                  "attributes of const graph must be read-only");
+    BOOST_CHECK_EQUAL(view.node_attribute<int>("age")[a], 31);
+
+    BOOST_CHECK_THROW(g.add_node_attribute<uncopyable_value>("broken"), std::runtime_error);
+    BOOST_CHECK(!g.has_node_attribute("broken"));
+    BOOST_CHECK_THROW(g.node_attribute<uncopyable_value>("broken"), std::runtime_error);
+    graph_t<int> after_failure(g);
+    BOOST_CHECK(!after_failure.has_node_attribute("broken"));
+}
+
+BOOST_AUTO_TEST_CASE(test_compressed_graph)
+{
+    std::mt19937 random(17);
+    size_t n = 5000;
+    std::uniform_int_distribution<size_t> node(0, n - 1);
+    std::uniform_int_distribution<int> offset(-20, 20);
+    std::vector<std::pair<size_t, size_t>> edges;
+    for (size_t i = 0; i < 10 * n; ++i) {
+        size_t source = node(random);
+        size_t target = (source + n + offset(random)) % n;
+        edges.push_back(std::make_pair(source, i % 50 == 0 ? node(random) : target));
+    }
+    auto g = graph_t<int>::from_edge_list(n, edges);
+    compressed_graph_t<uint32_t> compressed(g);
+
+    BOOST_CHECK_EQUAL(compressed.get_nodes_count(), n);
+    BOOST_CHECK_EQUAL(compressed.get_edges_count(), edges.size());
+    BOOST_CHECK_LT(compressed.get_bytes_count(), edges.size() * 3);
+
+    for (size_t source = 0; source < n; ++source) {
+        std::vector<size_t> expected;
+        g.for_each_edge(source, [&](size_t edge) {
+            expected.push_back(g.get_target(edge));
+        });
+        std::sort(expected.begin(), expected.end());
+        std::vector<size_t> actual;
+        compressed.for_each_neighbour(static_cast<uint32_t>(source), [&](uint32_t target) {
+            actual.push_back(target);
+        });
+        BOOST_CHECK(actual == expected);
+        BOOST_CHECK_EQUAL(compressed.get_degree(static_cast<uint32_t>(source)), expected.size());
+    }
+
+    std::set<size_t> expected;
+    g.dfs(0, [&expected](size_t node) {
+        expected.insert(node);
+    }, [](size_t) {}, [](size_t) {});
+    std::set<size_t> started;
+    std::set<size_t> ended;
+    compressed.dfs(0, [&started](uint32_t node) {
+        BOOST_CHECK(started.insert(node).second);
+    }, [&ended](uint32_t node) {
+        BOOST_CHECK(ended.insert(node).second);
+    }, [](uint32_t) {});
+    BOOST_CHECK(started == expected);
+    BOOST_CHECK(ended == expected);
+
+    graph_t<int> small;
+    for (size_t i = 0; i < 300; ++i)
+        small.add_node();
+    BOOST_CHECK_THROW(compressed_graph_t<uint8_t> tiny(small), std::runtime_error);
+    BOOST_CHECK_THROW((compressed_graph_t<uint32_t, uint8_t>(small)), std::runtime_error);
+
+    std::vector<std::pair<size_t, size_t>> sorted = edges;
+    std::stable_sort(sorted.begin(), sorted.end(), [](std::pair<size_t, size_t> const& a, std::pair<size_t, size_t> const& b) {
+        return a.first < b.first;
+    });
+    auto streamed = compressed_graph_t<uint32_t>::from_sorted_edges(n, sorted.begin(), sorted.end());
+    BOOST_CHECK_EQUAL(streamed.get_nodes_count(), n);
+    BOOST_CHECK_EQUAL(streamed.get_edges_count(), edges.size());
+    BOOST_CHECK_EQUAL(streamed.get_bytes_count(), compressed.get_bytes_count());
+    for (size_t source = 0; source < n; ++source) {
+        std::vector<uint32_t> expected, actual;
+        compressed.for_each_neighbour(static_cast<uint32_t>(source), [&](uint32_t target) {
+            expected.push_back(target);
+        });
+        streamed.for_each_neighbour(static_cast<uint32_t>(source), [&](uint32_t target) {
+            actual.push_back(target);
+        });
+        BOOST_CHECK(actual == expected);
+    }
+
+    csr_t snapshot(streamed);
+    BOOST_CHECK_EQUAL(snapshot.get_edges_count(), edges.size());
+    for (size_t source = 0; source < n; ++source)
+        BOOST_CHECK_EQUAL(snapshot.get_degree(source), streamed.get_degree(static_cast<uint32_t>(source)));
+
+    std::sort(sorted.begin(), sorted.end());
+    auto ordered = graph_t<int>::from_edge_list(n, sorted);
+    std::vector<size_t> expected_order, expected_discovered;
+    ordered.bfs(0, [&expected_order](size_t node) {
+        expected_order.push_back(node);
+    }, [&expected_discovered](size_t node) {
+        expected_discovered.push_back(node);
+    });
+    std::vector<size_t> actual_order, actual_discovered;
+    streamed.bfs(0, [&actual_order](uint32_t node) {
+        actual_order.push_back(node);
+    }, [&actual_discovered](uint32_t node) {
+        actual_discovered.push_back(node);
+    });
+    BOOST_CHECK(actual_order == expected_order);
+    BOOST_CHECK(actual_discovered == expected_discovered);
+
+    BOOST_CHECK_THROW(compressed_graph_t<uint32_t>::from_sorted_edges(n, edges.begin(), edges.end()), std::runtime_error);
+    std::vector<std::tuple<size_t, size_t, int>> outside(1, std::make_tuple(0, n, 1));
+    BOOST_CHECK_THROW(compressed_graph_t<uint32_t>::from_sorted_edges(n, outside.begin(), outside.end()), std::runtime_error);
+    auto isolated = compressed_graph_t<uint64_t, uint64_t>::from_sorted_edges(10, sorted.begin(), sorted.begin());
+    BOOST_CHECK_EQUAL(isolated.get_nodes_count(), 10);
+    BOOST_CHECK_EQUAL(isolated.get_edges_count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_bfs)
+{
+    graph_t<int> g;
+    for (size_t i = 0; i < 200; ++i)
+        g.add_node();
+    std::mt19937 random(13);
+    std::uniform_int_distribution<size_t> node(0, 199);
+    for (size_t i = 0; i < 600; ++i)
+        g.add_edge(node(random), node(random));
+    g.remove_node(17);
+
+    std::vector<size_t> level(g.get_nodes_count(), invalid_handle);
+    std::queue<size_t> queue;
+    level[0] = 0;
+    queue.push(0);
+    while (!queue.empty()) {
+        size_t current = queue.front();
+        queue.pop();
+        g.for_each_edge(current, [&](size_t edge) {
+            size_t next = g.get_target(edge);
+            if (level[next] == invalid_handle) {
+                level[next] = level[current] + 1;
+                queue.push(next);
+            }
+        });
+    }
+
+    std::vector<size_t> order;
+    size_t discovered = 0;
+    graph_t<int> const& view = g;
+    view.bfs(0, [&order](size_t node) {
+        order.push_back(node);
+    }, [&discovered](size_t) {
+        ++discovered;
+    });
+    size_t reached = 0;
+    for (size_t l : level)
+        reached += l != invalid_handle;
+    BOOST_CHECK_EQUAL(order.size(), reached);
+    BOOST_CHECK_GE(discovered, reached - 1);
+    for (size_t i = 1; i < order.size(); ++i)
+        BOOST_CHECK_LE(level[order[i - 1]], level[order[i]]);
+
+    size_t visited = 0;
+    g.bfs(17, [&visited](size_t) {
+        ++visited;
+    }, [](size_t) {});
+    BOOST_CHECK_EQUAL(visited, 0);
+
+    reset_traversal_stats();
+    view.dfs(0, [](size_t) {}, [](size_t) {}, [](size_t) {});
+#ifdef GRAPH_STATS
+    BOOST_CHECK_EQUAL(get_traversal_stats().nodes_visited, reached);
+#else
+    BOOST_CHECK_EQUAL(get_traversal_stats().nodes_visited, 0);
+#endif
+
+    graph_t<int> triangle;
+    for (size_t i = 0; i < 3; ++i)
+        triangle.add_node();
+    triangle.add_edge(0, 1);
+    triangle.remove_edge(triangle.add_edge(0, 2));
+    triangle.add_edge(1, 2);
+    reset_traversal_stats();
+    triangle.dfs(0, [](size_t) {}, [](size_t) {}, [](size_t) {});
+#ifdef GRAPH_STATS
+    BOOST_CHECK_EQUAL(get_traversal_stats().nodes_visited, 3);
+    BOOST_CHECK_EQUAL(get_traversal_stats().edges_scanned, 2);
+#else
+    BOOST_CHECK_EQUAL(get_traversal_stats().edges_scanned, 0);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(test_reachability_index)
+{
+    graph_t<int> g;
+    std::mt19937 random(17);
+    std::uniform_int_distribution<size_t> node(0, 149);
+    for (size_t i = 0; i < 150; ++i)
+        g.add_node();
+    for (size_t i = 0; i < 160; ++i)
+        g.add_edge(node(random), node(random));
+
+    auto check = [](graph_t<int> const& graph, reachability_index_t const& index) {
+        BOOST_CHECK_EQUAL(index.get_nodes_count(), graph.get_nodes_count());
+        for (size_t source = 0; source < graph.get_nodes_count(); ++source) {
+            std::vector<bool> expected(graph.get_nodes_count());
+            graph.dfs(source, [&expected](size_t node) {
+                expected[node] = true;
+            }, [](size_t) {}, [](size_t) {});
+            for (size_t target = 0; target < graph.get_nodes_count(); ++target)
+                BOOST_CHECK_EQUAL(index.reachable(source, target), expected[target]);
+        }
+    };
+
+    reachability_index_t index(g);
+    check(g, index);
+
+    for (size_t i = 0; i < 40; ++i)
+        BOOST_CHECK_EQUAL(index.add_node(), g.add_node());
+    std::uniform_int_distribution<size_t> any(0, g.get_nodes_count() - 1);
+    for (size_t i = 0; i < 120; ++i) {
+        size_t a = any(random);
+        size_t b = any(random);
+        g.add_edge(a, b);
+        index.add_edge(a, b);
+    }
+    check(g, index);
+
+    reachability_index_t empty;
+    BOOST_CHECK_EQUAL(empty.add_node(), 0);
+    BOOST_CHECK(empty.reachable(0, 0));
+    BOOST_CHECK_THROW(empty.reachable(0, 1), std::runtime_error);
+}
@@ -0,0 +1,115 @@
+#include <graph.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+
+namespace {
+    typedef std::vector<std::pair<size_t, size_t>> edge_list_t;
+
+    edge_list_t erdos_renyi(size_t n, size_t m, std::mt19937& random) {
+        std::uniform_int_distribution<size_t> node(0, n - 1);
+        edge_list_t edges;
+        edges.reserve(m);
+        for (size_t i = 0; i < m; ++i)
+            edges.push_back(std::make_pair(node(random), node(random)));
+        return edges;
+    }
+
+    /**
+    * Recursive matrix generator with Graph500 probabilities (0.57, 0.19, 0.19, 0.05)
+    */
+    edge_list_t rmat(size_t scale, size_t m, std::mt19937& random) {
+        std::uniform_real_distribution<double> quadrant(0, 1);
+        edge_list_t edges;
+        edges.reserve(m);
+        for (size_t i = 0; i < m; ++i) {
+            size_t a = 0;
+            size_t b = 0;
+            for (size_t bit = 0; bit < scale; ++bit) {
+                double p = quadrant(random);
+                a = a * 2 + (p >= 0.76);
+                b = b * 2 + ((p >= 0.57 && p < 0.76) || p >= 0.95);
+            }
+            edges.push_back(std::make_pair(a, b));
+        }
+        return edges;
+    }
+
+    template<typename Action>
+    double measure(Action action) {
+        auto start = std::chrono::steady_clock::now();
+        action();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void report(std::string const& graph, std::string const& operation, double ms) {
+        std::cout << std::left << std::setw(16) << graph << std::setw(18) << operation
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(2) << ms << " ms";
+#ifdef GRAPH_STATS
+        traversal_stats stats = get_traversal_stats();
+        std::cout << "  nodes " << stats.nodes_visited << " edges " << stats.edges_scanned
+                  << " frontier " << stats.max_frontier << " allocations " << stats.allocations;
+        reset_traversal_stats();
+#endif
+        std::cout << std::endl;
+    }
+
+    void run(std::string const& name, size_t n, edge_list_t const& edges) {
+        typedef graph_t<int> graph;
+        graph g;
+        reset_traversal_stats();
+        report(name, "from_edge_list", measure([&]() {
+            g = graph::from_edge_list(n, edges);
+        }));
+        report(name, "add_edge", measure([&]() {
+            graph h;
+            h.reserve_nodes(n);
+            h.reserve_edges(edges.size());
+            for (size_t i = 0; i < n; ++i)
+                h.add_node();
+            for (auto const& edge : edges)
+                h.add_edge(edge.first, edge.second);
+        }));
+
+        std::string filename = "graph-bench-" + name + ".txt";
+        g.save_to_file(filename);
+        report(name, "load", measure([&]() {
+            graph h;
+            h.load_from_file(filename);
+        }));
+        std::remove(filename.c_str());
+
+        size_t visited = 0;
+        report(name, "dfs", measure([&]() {
+            g.dfs(0, [&visited](size_t) {
+                ++visited;
+            }, [](size_t) {}, [](size_t) {});
+        }));
+        report(name, "bfs", measure([&]() {
+            g.bfs(0, [&visited](size_t) {
+                ++visited;
+            }, [](size_t) {});
+        }));
+    }
+}
+
+/**
+* Generates RMAT and Erdos-Renyi graphs of several scales with 16 edges per node and times
+* construction, loading and traversals. Pass maximal scale as the first argument (default 18).
+* When built with GRAPH_STATS prints traversal counters after each timing.
+*/
+int main(int argc, char** argv) {
+    size_t max_scale = argc > 1 ? std::stoul(argv[1]) : 18;
+    std::mt19937 random(2014);
+    for (size_t scale = 12; scale <= max_scale; scale += 3) {
+        size_t n = size_t(1) << scale;
+        size_t m = n * 16;
+        run("rmat-" + std::to_string(scale), n, rmat(scale, m, random));
+        run("er-" + std::to_string(scale), n, erdos_renyi(n, m, random));
+    }
+    return 0;
+}
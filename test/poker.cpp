@@ -0,0 +1,101 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE Poker
+#include <boost/test/unit_test.hpp>
+
+#include <poker/deck.h>
+#include <poker/hand.h>
+#include <poker/rules.h>
+
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+using namespace poker;
+
+namespace {
+    typedef std::pair<card_suit, card_rank> card_spec;
+
+    /**
+    * Builds a hand from the given cards taken out of a fresh, unshuffled deck
+    */
+    hand_t make_hand(std::initializer_list<card_spec> specs) {
+        // fresh deck is ordered by suit, then by rank
+        deck_t deck;
+        std::vector<card_t> cards;
+        for (size_t i = 0; i < 4 * (card_rank::ACE + 1); ++i)
+            cards.push_back(deck.take());
+
+        hand_t hand(0);
+        for (card_spec const& spec : specs)
+            hand.add_card(std::move(cards[spec.first * (card_rank::ACE + 1) + spec.second]));
+        return hand;
+    }
+
+    uint32_t rank_of(std::initializer_list<card_spec> specs) {
+        return simple_rules::get_combination_rank(make_hand(specs));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(poker_combination_categories)
+{
+    uint32_t straight_flush = rank_of({{HEARTS, D5}, {HEARTS, D6}, {HEARTS, D7}, {HEARTS, D8}, {HEARTS, D9}});
+    uint32_t quads = rank_of({{CLUBS, KING}, {DIAMONDS, KING}, {HEARTS, KING}, {SPADES, KING}, {CLUBS, D2}});
+    uint32_t full_house = rank_of({{CLUBS, D3}, {CLUBS, QUEEN}, {DIAMONDS, QUEEN}, {SPADES, D3}, {HEARTS, QUEEN}});
+    uint32_t flush = rank_of({{CLUBS, D2}, {CLUBS, D5}, {CLUBS, D9}, {CLUBS, JACK}, {CLUBS, ACE}});
+    uint32_t straight = rank_of({{CLUBS, D10}, {HEARTS, JACK}, {CLUBS, QUEEN}, {SPADES, KING}, {DIAMONDS, ACE}});
+    uint32_t set = rank_of({{CLUBS, D7}, {DIAMONDS, D7}, {HEARTS, D7}, {SPADES, KING}, {CLUBS, D2}});
+    uint32_t two_pairs = rank_of({{CLUBS, D4}, {CLUBS, D9}, {DIAMONDS, ACE}, {SPADES, D9}, {HEARTS, ACE}});
+    uint32_t pair = rank_of({{CLUBS, JACK}, {DIAMONDS, JACK}, {HEARTS, D8}, {SPADES, D5}, {CLUBS, D3}});
+    uint32_t highest_card = rank_of({{CLUBS, KING}, {DIAMONDS, D10}, {HEARTS, D7}, {SPADES, D4}, {CLUBS, D2}});
+
+    // ranks are packed into nibbles: larger groups first, higher ranks first within a group
+    BOOST_CHECK_EQUAL(straight_flush, STRAIGHT_FLUSH | 0x76543u);
+    BOOST_CHECK_EQUAL(quads, QUADS | 0xB0u);
+    BOOST_CHECK_EQUAL(full_house, FULL_HOUSE | 0xA1u);
+    BOOST_CHECK_EQUAL(flush, FLUSH | 0xC9730u);
+    BOOST_CHECK_EQUAL(straight, STRAIGHT | 0xCBA98u);
+    BOOST_CHECK_EQUAL(set, SET | 0x5B0u);
+    BOOST_CHECK_EQUAL(two_pairs, TWO_PAIRS | 0xC72u);
+    BOOST_CHECK_EQUAL(pair, PAIR | 0x9631u);
+    BOOST_CHECK_EQUAL(highest_card, HIGHEST_CARD | 0xB8520u);
+
+    BOOST_CHECK(straight_flush > quads);
+    BOOST_CHECK(quads > full_house);
+    BOOST_CHECK(full_house > flush);
+    BOOST_CHECK(flush > straight);
+    BOOST_CHECK(straight > set);
+    BOOST_CHECK(set > two_pairs);
+    BOOST_CHECK(two_pairs > pair);
+    BOOST_CHECK(pair > highest_card);
+
+    BOOST_CHECK_EQUAL(get_combination_name(straight_flush), "Straight flush");
+    BOOST_CHECK_EQUAL(get_combination_name(quads), "Quads");
+    BOOST_CHECK_EQUAL(get_combination_name(full_house), "Full house");
+    BOOST_CHECK_EQUAL(get_combination_name(flush), "Flush");
+    BOOST_CHECK_EQUAL(get_combination_name(straight), "Straight");
+    BOOST_CHECK_EQUAL(get_combination_name(set), "Set");
+    BOOST_CHECK_EQUAL(get_combination_name(two_pairs), "Two pairs");
+    BOOST_CHECK_EQUAL(get_combination_name(pair), "Pair");
+    BOOST_CHECK_EQUAL(get_combination_name(highest_card), "Highest card");
+}
+
+BOOST_AUTO_TEST_CASE(poker_straight_edges)
+{
+    // the highest straight ends exactly at the ace
+    BOOST_CHECK_EQUAL(rank_of({{HEARTS, D10}, {HEARTS, JACK}, {HEARTS, QUEEN}, {HEARTS, KING}, {HEARTS, ACE}}),
+                      STRAIGHT_FLUSH | 0xCBA98u);
+
+    // the ace only counts high, so A-2-3-4-5 is not a straight
+    BOOST_CHECK_EQUAL(rank_of({{CLUBS, ACE}, {DIAMONDS, D2}, {HEARTS, D3}, {SPADES, D4}, {CLUBS, D5}}),
+                      HIGHEST_CARD | 0xC3210u);
+    BOOST_CHECK_EQUAL(rank_of({{SPADES, ACE}, {SPADES, D2}, {SPADES, D3}, {SPADES, D4}, {SPADES, D5}}),
+                      FLUSH | 0xC3210u);
+
+    // runs starting at jack or higher would need ranks above the ace and must not wrap around
+    BOOST_CHECK_EQUAL(rank_of({{CLUBS, JACK}, {DIAMONDS, JACK}, {HEARTS, QUEEN}, {SPADES, KING}, {CLUBS, ACE}}),
+                      PAIR | 0x9CBAu);
+    BOOST_CHECK_EQUAL(rank_of({{CLUBS, JACK}, {DIAMONDS, QUEEN}, {HEARTS, KING}, {SPADES, ACE}, {CLUBS, D2}}),
+                      HIGHEST_CARD | 0xCBA90u);
+    BOOST_CHECK_EQUAL(rank_of({{CLUBS, KING}, {DIAMONDS, KING}, {HEARTS, ACE}, {SPADES, ACE}, {CLUBS, ACE}}),
+                      FULL_HOUSE | 0xCBu);
+}
@@ -3,6 +3,12 @@
 #include <boost/test/unit_test.hpp>
 
 #include <smart_ptr.h>
+#include <intrusive_smart_ptr.h>
+#include <pool_allocator.h>
+#include <set>
+#include <vector>
+#include <string>
+#include <stdexcept>
 
 BOOST_AUTO_TEST_CASE(smart_ptr_construct)
 {
@@ -65,4 +71,521 @@ BOOST_AUTO_TEST_CASE(smart_ptr_multithread_counting)
 		 	|| (counter_a == 0 && counter_b == 1)
 		 	|| (counter_a == 0 && counter_b == 0));
 	}
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE(smart_ptr_size)
+{
+	BOOST_CHECK_EQUAL(sizeof(smart_ptr<int>), sizeof(smart_ptr_detail::state_word));
+	BOOST_CHECK_GE(sizeof(smart_ptr<int>), sizeof(int*));
+}
+
+BOOST_AUTO_TEST_CASE(smart_ptr_concurrent_copy_and_assign)
+{
+	std::atomic_int created(0);
+	std::atomic_int deleted(0);
+	{
+		auto shared = make_smart<deletion_counter>(deleted);
+		++created;
+		std::atomic_bool stop(false);
+		std::atomic_int failures(0);
+		std::vector<std::thread> readers;
+		for (size_t i = 0; i < 3; ++i) {
+			readers.emplace_back([&shared, &stop, &failures]() {
+				while (!stop) {
+					smart_ptr<deletion_counter> copy = shared;
+					failures += !copy;
+					smart_ptr<deletion_counter> moved = std::move(copy);
+					failures += !moved || (bool) copy;
+				}
+			});
+		}
+		for (size_t i = 0; i < 20000; ++i) {
+			shared = make_smart<deletion_counter>(deleted);
+			++created;
+		}
+		stop = true;
+		for (std::thread& reader : readers)
+			reader.join();
+		BOOST_CHECK_EQUAL(failures, 0);
+		BOOST_CHECK_EQUAL(deleted, created - 1);
+	}
+	BOOST_CHECK_EQUAL(deleted, created);
+}
+
+struct throwing_value {
+	throwing_value() {
+		throw std::runtime_error("construction failed");
+	}
+};
+
+BOOST_AUTO_TEST_CASE(smart_ptr_make_smart)
+{
+	std::atomic_int counter(0);
+	{
+		auto a = make_smart<deletion_counter>(counter);
+		smart_ptr<deletion_counter> b = a;
+		BOOST_CHECK_EQUAL(&a->deletions, &counter);
+		BOOST_CHECK_EQUAL(a.get(), b.get());
+		a.reset();
+		BOOST_CHECK_EQUAL(counter, 0);
+	}
+	BOOST_CHECK_EQUAL(counter, 1);
+
+	auto text = make_smart<std::string>(3, 'x');
+	BOOST_CHECK_EQUAL(*text, "xxx");
+	BOOST_CHECK_EQUAL(text->size(), 3);
+
+	BOOST_CHECK_THROW(make_smart<throwing_value>(), std::runtime_error);
+	smart_ptr<int> empty(nullptr);
+	BOOST_CHECK(!empty);
+}
+
+struct intrusive_node : intrusive_ref_counter<intrusive_node> {
+	deletion_counter counter;
+	intrusive_smart_ptr<intrusive_node> next;
+
+	intrusive_node(std::atomic_int& deletions)
+		: counter(deletions)
+	{}
+};
+
+BOOST_AUTO_TEST_CASE(intrusive_smart_ptr_counting)
+{
+	BOOST_CHECK_EQUAL(sizeof(intrusive_smart_ptr<intrusive_node>), sizeof(intrusive_node*));
+
+	std::atomic_int deletions(0);
+	{
+		auto a = make_intrusive<intrusive_node>(deletions);
+		BOOST_CHECK_EQUAL(a->use_count(), 1);
+		intrusive_smart_ptr<intrusive_node> b = a;
+		BOOST_CHECK_EQUAL(a->use_count(), 2);
+		BOOST_CHECK(a == b);
+
+		intrusive_smart_ptr<intrusive_node> c(a.get());
+		BOOST_CHECK_EQUAL(a->use_count(), 3);
+		a->next = make_intrusive<intrusive_node>(deletions);
+		a.reset();
+		b.reset();
+		BOOST_CHECK_EQUAL(deletions, 0);
+		BOOST_CHECK_EQUAL(c->use_count(), 1);
+
+		intrusive_smart_ptr<intrusive_node> moved = std::move(c);
+		BOOST_CHECK(!c);
+		BOOST_CHECK_EQUAL(moved->use_count(), 1);
+	}
+	BOOST_CHECK_EQUAL(deletions, 2);
+}
+
+BOOST_AUTO_TEST_CASE(intrusive_smart_ptr_multithread_counting)
+{
+	std::atomic_int deletions(0);
+	{
+		auto shared = make_intrusive<intrusive_node>(deletions);
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < 4; ++i) {
+			threads.emplace_back([shared]() {
+				for (size_t it = 0; it < 10000; ++it) {
+					intrusive_smart_ptr<intrusive_node> copy = shared;
+					copy.reset();
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+			thread.join();
+		BOOST_CHECK_EQUAL(shared->use_count(), 1);
+	}
+	BOOST_CHECK_EQUAL(deletions, 1);
+}
+
+BOOST_AUTO_TEST_CASE(weak_smart_ptr_lock)
+{
+	std::atomic_int deletions(0);
+	weak_smart_ptr<deletion_counter> weak;
+	BOOST_CHECK(weak.expired());
+	BOOST_CHECK(!weak.lock());
+	{
+		auto a = make_smart<deletion_counter>(deletions);
+		weak = a;
+		weak_smart_ptr<deletion_counter> copy = weak;
+		BOOST_CHECK(!copy.expired());
+		smart_ptr<deletion_counter> locked = copy.lock();
+		BOOST_CHECK(locked == a);
+		a.reset();
+		BOOST_CHECK_EQUAL(deletions, 0);
+		BOOST_CHECK(!weak.expired());
+	}
+	BOOST_CHECK_EQUAL(deletions, 1);
+	BOOST_CHECK(weak.expired());
+	BOOST_CHECK(!weak.lock());
+
+	smart_ptr<int> adopted(new int(7));
+	weak_smart_ptr<int> weak_adopted = adopted;
+	BOOST_CHECK_EQUAL(*weak_adopted.lock(), 7);
+	adopted.reset();
+	BOOST_CHECK(weak_adopted.expired());
+}
+
+BOOST_AUTO_TEST_CASE(weak_smart_ptr_multithread_lock)
+{
+	for (size_t it = 0; it < 200; ++it) {
+		std::atomic_int deletions(0);
+		auto owner = make_smart<deletion_counter>(deletions);
+		weak_smart_ptr<deletion_counter> weak = owner;
+		std::atomic_int failures(0);
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < 3; ++i) {
+			threads.emplace_back([weak, &deletions, &failures]() {
+				for (size_t k = 0; k < 200; ++k) {
+					smart_ptr<deletion_counter> locked = weak.lock();
+					failures += locked && deletions != 0;
+				}
+			});
+		}
+		owner.reset();
+		for (std::thread& thread : threads)
+			thread.join();
+		BOOST_CHECK_EQUAL(failures, 0);
+		BOOST_CHECK_EQUAL(deletions, 1);
+		BOOST_CHECK(weak.expired());
+	}
+}
+
+struct pool_deleter {
+	std::vector<int*>* pool;
+
+	void operator()(int* value) const {
+		pool->push_back(value);
+	}
+};
+
+template<typename T>
+struct counting_allocator {
+	typedef T value_type;
+
+	std::atomic_int* allocations;
+
+	counting_allocator(std::atomic_int* allocations)
+		: allocations(allocations)
+	{}
+
+	template<typename U>
+	counting_allocator(counting_allocator<U> const& other)
+		: allocations(other.allocations)
+	{}
+
+	T* allocate(size_t n) {
+		++*allocations;
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+
+	void deallocate(T* ptr, size_t) {
+		--*allocations;
+		::operator delete(ptr);
+	}
+};
+
+template<typename T, typename U>
+bool operator==(counting_allocator<T> const& a, counting_allocator<U> const& b) {
+	return a.allocations == b.allocations;
+}
+
+template<typename T, typename U>
+bool operator!=(counting_allocator<T> const& a, counting_allocator<U> const& b) {
+	return !(a == b);
+}
+
+BOOST_AUTO_TEST_CASE(smart_ptr_deleters_and_allocators)
+{
+	std::vector<int*> pool;
+	int value = 5;
+	{
+		smart_ptr<int> a(&value, pool_deleter{&pool});
+		smart_ptr<int> b = a;
+		BOOST_CHECK_EQUAL(*b, 5);
+	}
+	BOOST_CHECK_EQUAL(pool.size(), 1);
+	BOOST_CHECK_EQUAL(pool[0], &value);
+
+	std::atomic_int allocations(0);
+	{
+		smart_ptr<int> a(&value, pool_deleter{&pool}, counting_allocator<int>(&allocations));
+		BOOST_CHECK_EQUAL(allocations, 1);
+	}
+	BOOST_CHECK_EQUAL(allocations, 0);
+	BOOST_CHECK_EQUAL(pool.size(), 2);
+
+	std::atomic_int deletions(0);
+	weak_smart_ptr<deletion_counter> weak;
+	{
+		auto a = allocate_smart<deletion_counter>(counting_allocator<deletion_counter>(&allocations), deletions);
+		BOOST_CHECK_EQUAL(allocations, 1);
+		weak = a;
+	}
+	BOOST_CHECK_EQUAL(deletions, 1);
+	BOOST_CHECK_EQUAL(allocations, 1);
+	weak.reset();
+	BOOST_CHECK_EQUAL(allocations, 0);
+}
+
+BOOST_AUTO_TEST_CASE(smart_ptr_plain_counting)
+{
+	std::atomic_int deletions(0);
+	weak_smart_ptr<deletion_counter, plain_counting> weak;
+	{
+		auto a = make_smart<deletion_counter, plain_counting>(deletions);
+		smart_ptr<deletion_counter, plain_counting> b = a;
+		smart_ptr<deletion_counter, plain_counting> c = std::move(b);
+		BOOST_CHECK(!b);
+		weak = c;
+		a.reset();
+		BOOST_CHECK(weak.lock() == c);
+		BOOST_CHECK_EQUAL(deletions, 0);
+	}
+	BOOST_CHECK_EQUAL(deletions, 1);
+	BOOST_CHECK(weak.expired());
+
+	std::vector<int*> pool;
+	int value = 3;
+	{
+		smart_ptr<int, plain_counting> a(&value, pool_deleter{&pool});
+		smart_ptr<int, plain_counting> b;
+		b = a;
+		BOOST_CHECK_EQUAL(*b, 3);
+	}
+	BOOST_CHECK_EQUAL(pool.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(atomic_smart_ptr_operations)
+{
+	std::atomic_int deletions(0);
+	{
+		atomic_smart_ptr<deletion_counter> slot;
+		BOOST_CHECK(slot.is_lock_free());
+		BOOST_CHECK(!slot.load());
+
+		auto a = make_smart<deletion_counter>(deletions);
+		auto b = make_smart<deletion_counter>(deletions);
+		slot.store(a);
+		BOOST_CHECK(slot.load() == a);
+
+		smart_ptr<deletion_counter> expected = b;
+		BOOST_CHECK(!slot.compare_exchange_strong(expected, b));
+		BOOST_CHECK(expected == a);
+		BOOST_CHECK(slot.compare_exchange_strong(expected, b));
+		BOOST_CHECK(slot.load() == b);
+
+		smart_ptr<deletion_counter> previous = slot.exchange(nullptr);
+		BOOST_CHECK(previous == b);
+		BOOST_CHECK(!slot.load());
+		a.reset();
+		expected.reset();
+		BOOST_CHECK_EQUAL(deletions, 1);
+		slot = previous;
+	}
+	BOOST_CHECK_EQUAL(deletions, 2);
+}
+
+BOOST_AUTO_TEST_CASE(atomic_smart_ptr_multithread_publication)
+{
+	std::atomic_int deletions(0);
+	std::atomic_int created(1);
+	{
+		struct snapshot_t {
+			int first;
+			int second;
+			deletion_counter counter;
+
+			snapshot_t(int value, std::atomic_int& deletions)
+				: first(value)
+				, second(value)
+				, counter(deletions)
+			{}
+		};
+
+		atomic_smart_ptr<snapshot_t> slot(make_smart<snapshot_t>(0, deletions));
+		const int threads = 4;
+		const int increments = 2000;
+		std::atomic_int failures(0);
+		std::vector<std::thread> workers;
+		for (int i = 0; i < threads; ++i) {
+			workers.emplace_back([&]() {
+				for (int k = 0; k < increments; ++k) {
+					smart_ptr<snapshot_t> current = slot.load();
+					failures += current->first != current->second;
+					auto next = make_smart<snapshot_t>(current->first + 1, deletions);
+					++created;
+					while (!slot.compare_exchange_weak(current, next)) {
+						next = make_smart<snapshot_t>(current->first + 1, deletions);
+						++created;
+					}
+				}
+			});
+		}
+		for (std::thread& worker : workers)
+			worker.join();
+		BOOST_CHECK_EQUAL(failures, 0);
+		BOOST_CHECK_EQUAL(slot.load()->first, threads * increments);
+	}
+	BOOST_CHECK_EQUAL(deletions, created);
+}
+
+struct deferred_node {
+	deletion_counter counter;
+	smart_ptr<deferred_node, deferred_counting> next;
+
+	deferred_node(std::atomic_int& deletions)
+		: counter(deletions)
+	{}
+};
+
+BOOST_AUTO_TEST_CASE(smart_ptr_deferred_reclamation)
+{
+	reclaim_retired();
+	std::atomic_int deletions(0);
+	auto head = make_smart<deferred_node, deferred_counting>(deletions);
+	head->next = make_smart<deferred_node, deferred_counting>(deletions);
+	head->next->next = smart_ptr<deferred_node, deferred_counting>(new deferred_node(deletions));
+	weak_smart_ptr<deferred_node, deferred_counting> weak = head;
+	head.reset();
+	BOOST_CHECK_EQUAL(deletions, 0);
+	BOOST_CHECK(weak.expired());
+	BOOST_CHECK_EQUAL(reclaim_retired(), 3);
+	BOOST_CHECK_EQUAL(deletions, 3);
+	BOOST_CHECK_EQUAL(reclaim_retired(), 0);
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < 4; ++i) {
+		threads.emplace_back([&deletions]() {
+			for (size_t k = 0; k < 1000; ++k)
+				make_smart<deferred_node, deferred_counting>(deletions);
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+	BOOST_CHECK_EQUAL(reclaim_retired(), 4000);
+	BOOST_CHECK_EQUAL(deletions, 4003);
+}
+
+BOOST_AUTO_TEST_CASE(smart_ptr_background_reclaimer)
+{
+	std::atomic_int deletions(0);
+	{
+		background_reclaimer reclaimer(std::chrono::milliseconds(1));
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < 2; ++i) {
+			threads.emplace_back([&deletions]() {
+				smart_ptr<deferred_node, deferred_counting> list;
+				for (size_t k = 0; k < 2000; ++k) {
+					auto node = make_smart<deferred_node, deferred_counting>(deletions);
+					if (k % 100 != 0)
+						node->next = list;
+					list = node;
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+	BOOST_CHECK_EQUAL(deletions, 4000);
+}
+
+struct counted_value {
+	int value = 0;
+};
+
+BOOST_AUTO_TEST_CASE(smart_ptr_stats_counters)
+{
+	smart_ptr_stats before = get_smart_ptr_stats<counted_value>();
+	{
+		auto a = make_smart<counted_value>();
+		smart_ptr<counted_value> b = a;
+		b->value = 1;
+		b.reset();
+		std::thread([a]() {
+			smart_ptr<counted_value> c = a;
+			c->value = 2;
+		}).join();
+	}
+	smart_ptr_stats after = get_smart_ptr_stats<counted_value>();
+#ifdef SMART_PTR_STATS
+	BOOST_CHECK_EQUAL(after.created - before.created, 1);
+	BOOST_CHECK_EQUAL(after.destroyed - before.destroyed, 1);
+	BOOST_CHECK_EQUAL(after.copies - before.copies, 3);
+	BOOST_CHECK_EQUAL(after.dereferences - before.dereferences, 2);
+	BOOST_CHECK_EQUAL(after.resets - before.resets, 1);
+	BOOST_CHECK_GT(after.lifetime_ns, before.lifetime_ns);
+#else
+	BOOST_CHECK_EQUAL(after.created, before.created);
+	BOOST_CHECK_EQUAL(after.copies, 0);
+#endif
+
+	atomic_smart_ptr<counted_value> slot(make_smart<counted_value>());
+	smart_ptr<counted_value> stale;
+	before = get_smart_ptr_stats<counted_value>();
+	BOOST_CHECK(!slot.compare_exchange_strong(stale, make_smart<counted_value>()));
+	after = get_smart_ptr_stats<counted_value>();
+#ifdef SMART_PTR_STATS
+	BOOST_CHECK_EQUAL(after.contention - before.contention, 1);
+#else
+	BOOST_CHECK_EQUAL(after.contention, 0);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(smart_ptr_pool_allocator)
+{
+	std::atomic_int deletions(0);
+	std::vector<smart_ptr<deletion_counter>> values;
+	for (size_t i = 0; i < 1000; ++i)
+		values.push_back(make_pooled<deletion_counter>(deletions));
+	std::set<deletion_counter*> addresses;
+	for (auto const& value : values) {
+		BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(value.get()) % alignof(deletion_counter), 0);
+		addresses.insert(value.get());
+	}
+	BOOST_CHECK_EQUAL(addresses.size(), values.size());
+
+	std::thread([&values]() {
+		values.resize(500);
+	}).join();
+	BOOST_CHECK_EQUAL(deletions, 500);
+	values.clear();
+	BOOST_CHECK_EQUAL(deletions, 1000);
+
+	std::vector<smart_ptr<deletion_counter>> foreign(1000);
+	std::thread([&foreign, &deletions]() {
+		for (auto& value : foreign)
+			value = make_pooled<deletion_counter>(deletions);
+	}).join();
+	foreign.clear();
+	BOOST_CHECK_EQUAL(deletions, 2000);
+
+	pool_allocator<std::string> strings;
+	std::vector<int, pool_allocator<int>> numbers(100, 7);
+	BOOST_CHECK_EQUAL(numbers[99], 7);
+	std::string* text = strings.allocate(1);
+	new (text) std::string("pooled");
+	BOOST_CHECK_EQUAL(*text, "pooled");
+	text->~basic_string();
+	strings.deallocate(text, 1);
+}
+
+struct pool_exit_user {
+	std::atomic_int* deletions = nullptr;
+	smart_ptr<deletion_counter> value;
+
+	~pool_exit_user() {
+		value.reset();
+		smart_ptr<deletion_counter> late = make_pooled<deletion_counter>(*deletions);
+	}
+};
+
+BOOST_AUTO_TEST_CASE(smart_ptr_pool_allocator_thread_exit)
+{
+	std::atomic_int deletions(0);
+	std::thread([&deletions]() {
+		static thread_local pool_exit_user user;
+		user.deletions = &deletions;
+		user.value = make_pooled<deletion_counter>(deletions);
+	}).join();
+	BOOST_CHECK_EQUAL(deletions, 2);
+}
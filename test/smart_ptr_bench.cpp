@@ -0,0 +1,147 @@
+#include <smart_ptr.h>
+#include <intrusive_smart_ptr.h>
+#include <pool_allocator.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <thread>
+
+namespace {
+	struct payload {
+		long value;
+
+		payload(long value)
+			: value(value)
+		{}
+	};
+
+	struct intrusive_payload : intrusive_ref_counter<intrusive_payload> {
+		long value;
+
+		intrusive_payload(long value)
+			: value(value)
+		{}
+	};
+
+	template<typename Action>
+	void measure(std::string const& name, size_t iterations, Action action) {
+		auto start = std::chrono::steady_clock::now();
+		long checksum = action();
+		double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		std::cout << std::left << std::setw(40) << name << std::right << std::setw(10) << std::fixed
+		          << std::setprecision(2) << ns / iterations << " ns/op  (" << checksum << ")" << std::endl;
+	}
+
+    /**
+    * Times creation, copying and dereference of pointers produced by given factory
+    */
+	template<typename Pointer, typename Factory>
+	void run(std::string const& name, size_t n, Factory factory) {
+		std::vector<Pointer> pointers;
+		pointers.reserve(n);
+		measure(name + " create", n, [&]() {
+			for (size_t i = 0; i < n; ++i)
+				pointers.push_back(factory(static_cast<long>(i)));
+			return static_cast<long>(pointers.size());
+		});
+		measure(name + " copy", n, [&]() {
+			long sum = 0;
+			for (size_t i = 0; i < n; ++i) {
+				Pointer copy = pointers[i];
+				sum += copy->value;
+			}
+			return sum;
+		});
+		measure(name + " dereference", n * 16, [&]() {
+			long sum = 0;
+			for (size_t round = 0; round < 16; ++round)
+				for (size_t i = 0; i < n; ++i)
+					sum += pointers[i]->value;
+			return sum;
+		});
+		measure(name + " destroy", n, [&]() {
+			pointers.clear();
+			return 0L;
+		});
+	}
+
+    /**
+    * Times threads copying, dereferencing and dropping a pointer to one shared value,
+    * which is the contended pattern of reference counting
+    */
+	template<typename Pointer>
+	void run_shared(std::string const& name, size_t threads, size_t n, Pointer const& shared) {
+		size_t iterations = n / threads;
+		std::vector<long> sums(threads);
+		measure(name + " x" + std::to_string(threads), iterations, [&]() {
+			std::vector<std::thread> workers;
+			for (size_t t = 0; t < threads; ++t) {
+				workers.emplace_back([&shared, &sums, iterations, t]() {
+					long sum = 0;
+					for (size_t i = 0; i < iterations; ++i) {
+						Pointer copy = shared;
+						sum += copy->value;
+					}
+					sums[t] = sum;
+				});
+			}
+			for (std::thread& worker : workers)
+				worker.join();
+			long sum = 0;
+			for (long value : sums)
+				sum += value;
+			return sum;
+		});
+	}
+}
+
+/**
+* Compares single threaded costs of raw pointers, smart_ptr and intrusive_smart_ptr, then wall time per
+* thread of copying one shared pointer under 1 to 64 threads, also against std::shared_ptr.
+* Pass number of pointers as the first argument (default 1000000). When built with SMART_PTR_STATS
+* prints smart_ptr counters at the end.
+*/
+int main(int argc, char** argv) {
+	size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+	std::vector<payload*> raw;
+	run<payload*>("raw", n, [&raw](long value) {
+		raw.push_back(new payload(value));
+		return raw.back();
+	});
+	for (payload* value : raw)
+		delete value;
+	run<smart_ptr<payload>>("smart_ptr(new)", n, [](long value) {
+		return smart_ptr<payload>(new payload(value));
+	});
+	run<smart_ptr<payload>>("make_smart", n, [](long value) {
+		return make_smart<payload>(value);
+	});
+	run<smart_ptr<payload, plain_counting>>("make_smart(plain_counting)", n, [](long value) {
+		return make_smart<payload, plain_counting>(value);
+	});
+	run<smart_ptr<payload>>("make_pooled", n, [](long value) {
+		return make_pooled<payload>(value);
+	});
+	run<intrusive_smart_ptr<intrusive_payload>>("make_intrusive", n, [](long value) {
+		return make_intrusive<intrusive_payload>(value);
+	});
+
+	payload raw_shared(1);
+	auto std_shared = std::make_shared<payload>(1);
+	auto smart_shared = make_smart<payload>(1);
+	auto intrusive_shared = make_intrusive<intrusive_payload>(1);
+	for (size_t threads = 1; threads <= 64; threads *= 2) {
+		run_shared<payload*>("shared raw", threads, n, &raw_shared);
+		run_shared("shared std::shared_ptr", threads, n, std_shared);
+		run_shared("shared smart_ptr", threads, n, smart_shared);
+		run_shared("shared intrusive_smart_ptr", threads, n, intrusive_shared);
+	}
+
+#ifdef SMART_PTR_STATS
+	dump_smart_ptr_stats<payload>(std::cout, "payload");
+#endif
+	return 0;
+}